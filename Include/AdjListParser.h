@@ -0,0 +1,184 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_ADJLISTPARSER_H
+#define PSA_ADJLISTPARSER_H
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "GraphTypes.h"
+
+namespace psa {
+
+class ThreadPool;
+
+/**
+ * One edge as read from an adjacency list: u -> v with value (length or cost).
+ */
+struct CsrEdge
+{
+    vertexid_t u;
+    vertexid_t v;
+    int value;
+};
+
+/**
+ * AdjListParser tokenizes the adjacency list text format straight out of a character buffer
+ * (typically a memory mapped file) without any regex or temporary strings.
+ *
+ * The format is: a line with "directed" or "undirected", a line with number of vertices
+ * followed by optional number of edges and then one line per vertex: the vertex id followed
+ * by whitespace separated "id" or "id,value" tokens for the adjacent vertices.
+ */
+class AdjListParser
+{
+public:
+    AdjListParser(const char* first, const char* last)
+        : m_first{first}
+        , m_pos{first}
+        , m_last{last}
+    {}
+
+    GraphType type() const { return m_type; }
+    std::size_t nvertices() const { return m_nvertices; }
+    std::size_t nedges() const { return m_nedges; }
+    bool hasEdgeCount() const { return m_hasEdgeCount; }
+    const char* position() const { return m_pos; }
+
+    void setVertexCount(std::size_t nvertices) { m_nvertices = nvertices; }
+
+    void parseHeader();
+
+    /**
+     * Parses the adjacency lines till the end of the buffer and calls
+     * func(vertexid_t u, vertexid_t v, int value) for every edge token, value is 0 when the
+     * token has no ",value" part.
+     */
+    template<typename EdgeFunc> void parseEdges(EdgeFunc func);
+
+    /**
+     * Parses the adjacency lines on all the threads of the pool. The rest of the buffer is split
+     * at line boundaries, one piece per thread, and every piece is parsed into its own edge list;
+     * the lists one after the other have the edges in file order.
+     */
+    std::vector<std::vector<CsrEdge>> parseEdges(ThreadPool& pool);
+
+    // splits [first, last) at line boundaries into at most nchunks pieces, returns boundaries
+    static std::vector<const char*> splitLines(const char* first, const char* last,
+                                               std::size_t nchunks);
+
+private:
+    static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    void skipBlanks()
+    {
+        while (m_pos < m_last && isBlank(*m_pos))
+            ++m_pos;
+    }
+    bool isLineEnd() const { return m_pos == m_last || *m_pos == '\n'; }
+    bool isTokenEnd() const { return m_pos == m_last || isBlank(*m_pos) || *m_pos == '\n'; }
+
+    unsigned long long parseUnsigned(const char* expected);
+    int parseInt();
+    vertexid_t parseVertexId();
+
+    [[noreturn]] void throwBadFormat(const char* expected) const;
+
+    const char* m_first;
+    const char* m_pos;
+    const char* m_last;
+
+    GraphType m_type{GraphType::Directed};
+    std::size_t m_nvertices{0};
+    std::size_t m_nedges{0};
+    bool m_hasEdgeCount{false};
+};
+
+inline unsigned long long AdjListParser::parseUnsigned(const char* expected)
+{
+    if (m_pos == m_last || !isDigit(*m_pos))
+        this->throwBadFormat(expected);
+
+    unsigned long long value = 0;
+    while (m_pos < m_last && isDigit(*m_pos)) {
+        value = value * 10 + static_cast<unsigned int>(*m_pos - '0');
+        if (value > std::numeric_limits<unsigned int>::max())
+            this->throwBadFormat(expected);
+        ++m_pos;
+    }
+
+    return value;
+}
+
+inline int AdjListParser::parseInt()
+{
+    bool negative = false;
+    if (m_pos < m_last && (*m_pos == '-' || *m_pos == '+')) {
+        negative = *m_pos == '-';
+        ++m_pos;
+    }
+
+    long long value = static_cast<long long>(this->parseUnsigned("edge value"));
+    if (negative)
+        value = -value;
+    if (value > std::numeric_limits<int>::max() || value < std::numeric_limits<int>::min())
+        this->throwBadFormat("edge value");
+
+    return static_cast<int>(value);
+}
+
+inline vertexid_t AdjListParser::parseVertexId()
+{
+    auto id = this->parseUnsigned("vertex id");
+    if (id >= m_nvertices)
+        throw AlgoException{fmt::format(AlgoException::InvalidIndex,
+                                        fmt::format("vertex id {}", id), 0, m_nvertices - 1)};
+    return static_cast<vertexid_t>(id);
+}
+
+template<typename EdgeFunc>
+void AdjListParser::parseEdges(EdgeFunc func)
+{
+    while (m_pos < m_last) {
+        this->skipBlanks();
+        if (this->isLineEnd()) { // empty line
+            if (m_pos < m_last)
+                ++m_pos;
+            continue;
+        }
+
+        vertexid_t u = this->parseVertexId();
+        if (!this->isTokenEnd())
+            this->throwBadFormat("vertex id");
+
+        for (;;) {
+            this->skipBlanks();
+            if (this->isLineEnd())
+                break;
+
+            vertexid_t v = this->parseVertexId();
+            int value = 0;
+            if (m_pos < m_last && *m_pos == ',') {
+                ++m_pos;
+                value = this->parseInt();
+            }
+            if (!this->isTokenEnd())
+                this->throwBadFormat("id or id,value");
+
+            func(u, v, value);
+        }
+    }
+}
+
+} // namespace psa
+
+#endif // PSA_ADJLISTPARSER_H
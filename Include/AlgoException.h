@@ -16,11 +16,27 @@ class AlgoException : public std::exception
 public:
     static const char* InvalidIndex;
     static const char* FileOpenRead;
+    static const char* FileOpenWrite;
+    static const char* FileMap;
+    static const char* FileWrite;
+    static const char* FileRead;
 
     static const char* StackUnderflow;
 
+    // Heap
+    static const char* HeapEmpty;
+    static const char* HeapIdNotFound;
+    static const char* HeapKeyNotMonotone;
+    static const char* HeapKeyIncreased;
+
     // Graph
     static const char* GraphBadFormat;
+    static const char* GraphBadCsrFile;
+    static const char* GraphBadIndexFile;
+    static const char* GraphIndexMismatch;
+    static const char* GraphIndexStale;
+    static const char* GraphNotAcyclic;
+    static const char* GraphClusterCount;
 
     // Matrix
     static const char* MatrixZeroDimension;
@@ -0,0 +1,87 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_ALTINDEX_H
+#define PSA_ALTINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DijkstraGraph.h"
+#include "GraphTypes.h"
+#include "MappedFile.h"
+#include "SearchContext.h"
+
+namespace psa {
+
+class CsrGraph;
+
+/**
+ * AltIndex speeds up repeated point to point queries on one graph with A*, landmarks and the
+ * triangle inequality: for every landmark L the distances d(L, v) and d(v, L) are stored, and
+ * max(d(L, t) - d(L, v), d(v, L) - d(t, L)) over the landmarks is a lower bound of d(v, t)
+ * that steers the search toward the target.
+ *
+ * The tables are built once per graph and can be saved next to it; load() maps the file and
+ * uses the tables in place. The index keeps the edge count and CsrGraph::checksum() of its
+ * graph, a query on any other graph throws rather than trust bounds that may overestimate.
+ *
+ * ALT file layout (native byte order), version 2:
+ *   header    - magic "PSAALT\0\0", version, reserved, nvertices, nlandmarks, nedges, checksum
+ *   landmarks - nlandmarks x uint32
+ *   from      - nvertices x nlandmarks x uint32, d(L, v) of vertex v at [v * nlandmarks + L]
+ *   to        - nvertices x nlandmarks x uint32, d(v, L) likewise
+ */
+class AltIndex
+{
+public:
+    static const std::uint32_t kVersion = 2;
+
+public:
+    AltIndex() = default;
+    AltIndex(const AltIndex& rhs) = delete;
+    AltIndex(AltIndex&& rhs) = default;
+
+    AltIndex& operator=(const AltIndex& rhs) = delete;
+    AltIndex& operator=(AltIndex&& rhs) = default;
+
+    static AltIndex build(const CsrGraph& graph, const CsrGraph& reverse, std::size_t nlandmarks);
+    static AltIndex load(const std::string& filePath);
+    void save(const std::string& filePath) const;
+
+    std::size_t nvertices() const { return m_nvertices; }
+    std::size_t nlandmarks() const { return m_nlandmarks; }
+    vertexid_t landmark(std::size_t i) const { return m_landmarks[i]; }
+    bool isMapped() const { return m_file.data() != nullptr; }
+
+    // lower bound of the distance from v to t, SearchContext::kInfinity if t can't be reached
+    unsigned int lowerBound(vertexid_t v, vertexid_t t) const;
+
+    ShortestPath shortestPath(const CsrGraph& graph,
+                              vertexid_t sourceVertexId, vertexid_t targetVertexId) const;
+    ShortestPath shortestPath(const CsrGraph& graph,
+                              vertexid_t sourceVertexId, vertexid_t targetVertexId,
+                              SearchContext& context) const;
+
+private:
+    std::size_t m_nvertices{0};
+    std::size_t m_nlandmarks{0};
+    std::size_t m_nedges{0};
+    std::uint64_t m_checksum{0};
+
+    const vertexid_t* m_landmarks{nullptr};
+    const unsigned int* m_from{nullptr};
+    const unsigned int* m_to{nullptr};
+
+    std::vector<vertexid_t> m_landmarkStorage{};
+    std::vector<unsigned int> m_fromStorage{};
+    std::vector<unsigned int> m_toStorage{};
+    MappedFile m_file{};
+};
+
+} // namespace psa
+
+#endif // PSA_ALTINDEX_H
@@ -0,0 +1,37 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_BORUVKAMINSPANNINGGRAPH_H
+#define PSA_BORUVKAMINSPANNINGGRAPH_H
+
+#include <vector>
+
+#include "AdjListParser.h"
+#include "GraphTypes.h"
+
+namespace psa {
+
+class CsrGraph;
+class ThreadPool;
+
+/**
+ * BoruvkaMinSpanningGraph finds the minimum spanning forest of a CSR graph in rounds. In every
+ * round each component's lightest edge to another component is found in parallel, over the
+ * vertices that still have such an edge, and all those edges are contracted at once through a
+ * ConcurrentUnionFind; the number of components at least halves per round. Ties are broken by
+ * edge id and an edge closing a cycle of equal costs is simply not united, so the cost is the
+ * same as Kruskal's and Prim's. Directed edges are taken as undirected, like Kruskal does.
+ */
+class BoruvkaMinSpanningGraph
+{
+public:
+    static long findMst(const CsrGraph& graph, ThreadPool& pool);
+    // the tree edges are stored in edges, once each, in no particular order
+    static long findMst(const CsrGraph& graph, ThreadPool& pool, std::vector<CsrEdge>& edges);
+};
+
+} // namespace psa
+
+#endif // PSA_BORUVKAMINSPANNINGGRAPH_H
@@ -9,9 +9,18 @@
 #include <vector>
 
 #include "Graph.h"
+#include "SearchContext.h"
 
 namespace psa {
 
+// breadth first search tree, -1 distance and SearchContext::kNoVertex parent if not reachable
+struct BreadthFirstTree
+{
+    std::vector<int> distances{};
+    std::vector<vertexid_t> parents{};
+    std::size_t nbottomUpLevels{0}; // levels a direction optimizing search expanded bottom up
+};
+
 class BreadthFirstGraphVertex : public Vertex
 {
 public:
@@ -37,7 +46,6 @@ class BreadthFirstGraph : public Graph<BreadthFirstGraphVertex, Edge<BreadthFirs
 {
 public:
     BreadthFirstGraph() = default;
-    ~BreadthFirstGraph();
 
     std::size_t nvertices() const override { return m_vertices.size(); }
     std::size_t nedges() const override { return m_edges.size(); }
@@ -46,19 +54,19 @@ public:
 
     void addVertex(vertexid_t id) override
     {
-        auto v = new BreadthFirstGraphVertex{id};
+        auto v = this->createVertex(id);
         m_vertices.push_back(v);
     }
     edgeid_t addEdge(edgeid_t id, BreadthFirstGraphVertex* u,
                  BreadthFirstGraphVertex* v, int /*value*/) override
     {
-        auto e = new Edge<BreadthFirstGraphVertex>{id, u, v};
+        auto e = this->createEdge(id, u, v);
         u->addEdge(e);
         m_edges.push_back(e);
         ++id;
 
         if (this->type() == Type::Undirected) {
-            e = new Edge<BreadthFirstGraphVertex>{id, v, u};
+            e = this->createEdge(id, v, u);
             v->addEdge(e);
             m_edges.push_back(e);
             ++id;
@@ -69,6 +77,44 @@ public:
 
     void traverse(vertexid_t startVertexId);
     unsigned int distance(vertexid_t startVertexId, vertexid_t endVertexId);
+    int distance(vertexid_t startVertexId, vertexid_t endVertexId, SearchContext& context) const;
+
+    static std::vector<int> traverse(const CsrGraph& graph, vertexid_t startVertexId);
+    static void traverse(const CsrGraph& graph, vertexid_t startVertexId, SearchContext& context);
+    static int distance(const CsrGraph& graph, vertexid_t startVertexId, vertexid_t endVertexId);
+    static int distance(const CsrGraph& graph, vertexid_t startVertexId, vertexid_t endVertexId,
+                        SearchContext& context);
+
+    /**
+     * Multi source search: up to 64 sources share one pass over the graph, every vertex keeps
+     * a word with a bit per source, so one edge scan serves all the searches of the batch.
+     * Larger source lists go in batches of 64. The first returns the hops to every vertex from
+     * each source (-1 if not reachable), the second the number of vertices at each level.
+     */
+    static std::vector<std::vector<int>> traverse(const CsrGraph& graph,
+                                                  const std::vector<vertexid_t>& startVertexIds);
+    static std::vector<std::vector<std::size_t>> countLevels(
+            const CsrGraph& graph, const std::vector<vertexid_t>& startVertexIds);
+
+    /**
+     * Level synchronous search on the pool: the threads take chunks of the frontier, claim a
+     * vertex by setting its visited bit atomically and collect the next frontier in buffers of
+     * their own.
+     */
+    static BreadthFirstTree traverse(const CsrGraph& graph, vertexid_t startVertexId,
+                                     ThreadPool& pool);
+
+    /**
+     * Direction optimizing search: a level expands top down from a queue while the frontier
+     * is small and bottom up, every unvisited vertex looking for a parent in a frontier bitmap,
+     * while it is large. Bottom up needs the incoming edges, reverse is graph.reverse() or the
+     * graph itself if it is undirected.
+     */
+    static BreadthFirstTree traverseDirectionOptimizing(const CsrGraph& graph,
+                                                        const CsrGraph& reverse,
+                                                        vertexid_t startVertexId);
+    static BreadthFirstTree traverseDirectionOptimizing(const CsrGraph& graph,
+                                                        vertexid_t startVertexId);
 
 private:
     void reserveVertices(std::size_t nvertices) override { m_vertices.reserve(nvertices); }
@@ -0,0 +1,120 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_BUCKETQUEUE_H
+#define PSA_BUCKETQUEUE_H
+
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "GraphTypes.h"
+
+namespace psa {
+
+/**
+ * BucketQueue is Dial's monotone priority queue: one bucket per key value in a ring that
+ * covers [current, current + nbuckets), popping scans forward to the next non empty bucket.
+ * It suits small integer edge lengths where the keys in the queue span at most the longest
+ * edge. The ring doubles when a pushed key falls beyond it, so the longest edge doesn't need
+ * to be known up front.
+ *
+ * Keys pushed must not be smaller than the last key popped. There is no decreaseKey, the same
+ * id is pushed again and the caller skips stale entries.
+ */
+template<typename Key>
+class BucketQueue
+{
+    static_assert(std::is_unsigned<Key>::value, "BucketQueue needs unsigned integer keys");
+
+public:
+    static const std::size_t kMinBuckets = 64;
+
+    struct Entry
+    {
+        Key key;
+        vertexid_t id;
+    };
+
+public:
+    BucketQueue() : m_buckets(kMinBuckets) {}
+
+    std::size_t size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    void push(vertexid_t id, Key key)
+    {
+        if (key < m_current)
+            throw AlgoException{fmt::format(AlgoException::HeapKeyNotMonotone, key, m_current)};
+
+        if (key - m_current >= m_buckets.size())
+            this->grow(key - m_current);
+
+        m_buckets[key & (m_buckets.size() - 1)].push_back(Entry{key, id});
+        ++m_size;
+    }
+
+    Entry pop();
+    void clear();
+
+private:
+    void grow(Key spread);
+
+    std::vector<std::vector<Entry>> m_buckets; // size is a power of 2
+    Key m_current{0};
+    std::size_t m_size{0};
+};
+
+template<typename Key>
+const std::size_t BucketQueue<Key>::kMinBuckets;
+
+template<typename Key>
+typename BucketQueue<Key>::Entry BucketQueue<Key>::pop()
+{
+    if (m_size == 0)
+        throw AlgoException{AlgoException::HeapEmpty};
+
+    const std::size_t mask = m_buckets.size() - 1;
+    while (m_buckets[m_current & mask].empty())
+        ++m_current;
+
+    std::vector<Entry>& bucket = m_buckets[m_current & mask];
+    Entry entry = bucket.back();
+    bucket.pop_back();
+    --m_size;
+
+    return entry;
+}
+
+template<typename Key>
+void BucketQueue<Key>::clear()
+{
+    for (auto& bucket : m_buckets)
+        bucket.clear();
+    m_current = 0;
+    m_size = 0;
+}
+
+// doubles the ring until it covers [current, current + spread]
+template<typename Key>
+void BucketQueue<Key>::grow(Key spread)
+{
+    std::size_t nbuckets = m_buckets.size();
+    while (spread >= nbuckets)
+        nbuckets *= 2;
+
+    std::vector<std::vector<Entry>> buckets(nbuckets);
+    for (auto& bucket : m_buckets) {
+        for (auto& entry : bucket)
+            buckets[entry.key & (nbuckets - 1)].push_back(entry);
+    }
+    m_buckets.swap(buckets);
+}
+
+} // namespace psa
+
+#endif // PSA_BUCKETQUEUE_H
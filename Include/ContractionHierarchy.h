@@ -0,0 +1,95 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_CONTRACTIONHIERARCHY_H
+#define PSA_CONTRACTIONHIERARCHY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DijkstraGraph.h"
+#include "GraphTypes.h"
+#include "SearchContext.h"
+
+namespace psa {
+
+class CsrGraph;
+class ThreadPool;
+
+/**
+ * ContractionHierarchy answers point to point shortest path queries on a static graph with a
+ * search over a few hundred vertices. build() contracts the vertices one level at a time, in
+ * the order of their edge difference (shortcuts added minus edges removed); contracting v
+ * adds a shortcut u -> w for every path u -> v -> w that has no equally short witness path
+ * around v. The rank of a vertex is the order it got contracted in.
+ *
+ * Every edge, original or shortcut, is kept either as an upward arc of its lower ranked end or
+ * as a downward arc of its lower ranked end; a query runs Dijkstra upward from the source and
+ * upward on the reversed downward arcs from the target, the shortest path goes over the
+ * highest ranked vertex of the path where the two searches meet. Shortcuts carry their middle
+ * vertex so the path can be unpacked to original edges.
+ *
+ * The hierarchy keeps the edge count and CsrGraph::checksum() of its graph, load() throws if
+ * the file was built for another graph than the one given.
+ *
+ * CH file layout (native byte order), version 2:
+ *   header   - magic "PSACH\0\0\0", version, reserved, nvertices, nup, ndown, nedges, checksum
+ *   ranks    - nvertices x uint32
+ *   up arcs  - offsets (nvertices + 1) x uint64, then targets, weights, middles nup x uint32
+ *   down arcs- likewise with ndown arcs
+ */
+class ContractionHierarchy
+{
+public:
+    static const std::uint32_t kVersion = 2;
+
+    // a witness search gives up, and the shortcut is added, after settling this many vertices
+    static const std::size_t kWitnessSettleLimit = 500;
+
+public:
+    ContractionHierarchy() = default;
+    ContractionHierarchy(const ContractionHierarchy& rhs) = delete;
+    ContractionHierarchy(ContractionHierarchy&& rhs) = default;
+
+    ContractionHierarchy& operator=(const ContractionHierarchy& rhs) = delete;
+    ContractionHierarchy& operator=(ContractionHierarchy&& rhs) = default;
+
+    static ContractionHierarchy build(const CsrGraph& graph, ThreadPool& pool);
+    static ContractionHierarchy load(const std::string& filePath, const CsrGraph& graph);
+    void save(const std::string& filePath) const;
+
+    std::size_t nvertices() const { return m_rank.size(); }
+    std::size_t narcs() const { return m_up.targets.size() + m_down.targets.size(); }
+    std::size_t nshortcuts() const;
+    vertexid_t rank(vertexid_t v) const { return m_rank[v]; }
+
+    ShortestPath shortestPath(vertexid_t sourceVertexId, vertexid_t targetVertexId) const;
+    ShortestPath shortestPath(vertexid_t sourceVertexId, vertexid_t targetVertexId,
+                              SearchContext& forward, SearchContext& backward) const;
+
+private:
+    // arcs in CSR form, middle is SearchContext::kNoVertex for an original edge
+    struct Arcs
+    {
+        std::vector<edgeid_t> offsets{};
+        std::vector<vertexid_t> targets{};
+        std::vector<unsigned int> weights{};
+        std::vector<vertexid_t> middles{};
+    };
+
+    static edgeid_t findArc(const Arcs& arcs, vertexid_t u, vertexid_t target);
+    void unpack(vertexid_t u, vertexid_t w, vertexid_t middle, std::vector<vertexid_t>& path) const;
+
+    std::size_t m_nedges{0}; // of the graph the hierarchy is built for
+    std::uint64_t m_checksum{0}; // CsrGraph::checksum() of that graph
+    std::vector<vertexid_t> m_rank{};
+    Arcs m_up{};   // u -> w with rank(u) < rank(w), kept at u
+    Arcs m_down{}; // w -> u with rank(u) < rank(w), kept at u with target w
+};
+
+} // namespace psa
+
+#endif // PSA_CONTRACTIONHIERARCHY_H
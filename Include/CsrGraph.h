@@ -0,0 +1,172 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_CSRGRAPH_H
+#define PSA_CSRGRAPH_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "GraphTypes.h"
+#include "MappedFile.h"
+
+namespace psa {
+
+/**
+ * CsrGraph holds the graph topology in compressed sparse row form: offsets has
+ * nvertices() + 1 entries and the edges of vertex u are [offsets[u], offsets[u+1]) in the
+ * contiguous targets and weights arrays. Undirected edges are stored in both directions.
+ *
+ * The arrays are either owned or point straight into a memory mapped CSR file (see load()),
+ * in that case the graph is a read only view of the file.
+ *
+ * CSR file layout (native byte order), version 1:
+ *   header   - magic "PSACSR\0\0", version, type, flags, reserved, nvertices, nedges
+ *   offsets  - (nvertices + 1) x uint64
+ *   targets  - nedges x uint32
+ *   weights  - nedges x int32, present only if flags has kHasWeights
+ */
+class CsrGraph
+{
+public:
+    static const std::uint32_t kVersion = 1;
+    static const std::uint32_t kHasWeights = 0x1;
+
+    // how much of a CSR file load() checks: the header and sizes only, or every edge as well
+    enum class Validate
+    {
+        Header,
+        Full
+    };
+
+public:
+    CsrGraph() = default;
+    CsrGraph(GraphType type, std::size_t nvertices, const std::vector<CsrEdge>& edges);
+    CsrGraph(const CsrGraph& rhs) = delete;
+    CsrGraph(CsrGraph&& rhs) = default;
+
+    CsrGraph& operator=(const CsrGraph& rhs) = delete;
+    CsrGraph& operator=(CsrGraph&& rhs) = default;
+
+    static CsrGraph fromAdjList(const std::string& filePath);
+    static CsrGraph fromAdjList(const std::string& filePath, ThreadPool& pool);
+    static CsrGraph load(const std::string& filePath, Validate validate = Validate::Header);
+    void save(const std::string& filePath) const;
+
+    CsrGraph reverse() const;
+    void validate() const;
+
+    GraphType type() const { return m_type; }
+    std::size_t nvertices() const { return m_nvertices; }
+    std::size_t nedges() const { return m_nedges; }
+    bool hasWeights() const { return m_weights != nullptr; }
+    bool isMapped() const { return m_file.data() != nullptr; }
+    // of the type, the offsets, the targets and the weights, for an index to tell its graph;
+    // computed on the first call so graphs that are never checked don't pay for the pass
+    std::uint64_t checksum() const;
+
+    const edgeid_t* offsets() const { return m_offsets; }
+    const vertexid_t* targets() const { return m_targets; }
+    const int* weights() const { return m_weights; }
+
+    edgeid_t edgeBegin(vertexid_t u) const { return m_offsets[u]; }
+    edgeid_t edgeEnd(vertexid_t u) const { return m_offsets[u + 1]; }
+    std::size_t degree(vertexid_t u) const { return m_offsets[u + 1] - m_offsets[u]; }
+    vertexid_t target(edgeid_t e) const { return m_targets[e]; }
+    int weight(edgeid_t e) const { return m_weights ? m_weights[e] : 0; }
+
+private:
+    void build(const std::vector<std::vector<CsrEdge>>& chunks, ThreadPool& pool);
+    std::uint64_t computeChecksum() const;
+
+    // checksum() cache, safe to fill from concurrent queries and carried along by moves
+    struct Checksum
+    {
+        Checksum() = default;
+        Checksum(Checksum&& rhs) : value{rhs.value}, ready{rhs.ready.load()} {}
+        Checksum& operator=(Checksum&& rhs)
+        {
+            value = rhs.value;
+            ready = rhs.ready.load();
+            return *this;
+        }
+
+        std::uint64_t value{0};
+        std::atomic<bool> ready{false};
+        std::mutex mutex{};
+    };
+
+    GraphType m_type{GraphType::Directed};
+    std::size_t m_nvertices{0};
+    std::size_t m_nedges{0};
+    mutable Checksum m_checksum{};
+
+    const edgeid_t* m_offsets{nullptr};
+    const vertexid_t* m_targets{nullptr};
+    const int* m_weights{nullptr};
+
+    std::vector<edgeid_t> m_offsetStorage{};
+    std::vector<vertexid_t> m_targetStorage{};
+    std::vector<int> m_weightStorage{};
+    MappedFile m_file{};
+};
+
+#ifdef UNIT_TEST
+// nedges edges between uniformly random vertices of [0, nvertices), the costs uniform in
+// costRange; the same seed gives the same edges
+std::vector<CsrEdge> randomCsrEdges(std::size_t nvertices, std::size_t nedges, unsigned int seed,
+                                    std::pair<int, int> costRange = {0, 0});
+CsrGraph randomCsrGraph(GraphType type, std::size_t nvertices, std::size_t nedges,
+                        unsigned int seed, std::pair<int, int> costRange = {0, 0});
+#endif
+
+/**
+ * Builds the graph from CSR topology, same as reading the adjacency list the CSR is made of.
+ * Undirected edges are stored twice in CSR and added once here.
+ */
+template<typename VertexType, typename EdgeType>
+void Graph<VertexType, EdgeType>::readCsr(const CsrGraph& graph)
+{
+    m_type = graph.type();
+
+    std::size_t nvertices = graph.nvertices();
+    this->reserve(nvertices, m_type == Type::Undirected ? graph.nedges() / 2 : graph.nedges());
+
+    for (vertexid_t i = 0; i < nvertices; ++i)
+        this->addVertex(i);
+
+    edgeid_t edgeid{0};
+    for (vertexid_t u = 0; u < nvertices; ++u) {
+        bool skipLoop = false; // a self loop u-u is stored as two u->u edges
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            if (m_type == Type::Undirected) {
+                if (v < u)
+                    continue;
+                if (v == u) {
+                    skipLoop = !skipLoop;
+                    if (!skipLoop)
+                        continue;
+                }
+            }
+            edgeid = this->addEdge(edgeid, this->vertex(u), this->vertex(v), graph.weight(e));
+        }
+    }
+}
+
+template<typename VertexType, typename EdgeType>
+void Graph<VertexType, EdgeType>::readCsr(const std::string& filePath)
+{
+    this->readCsr(CsrGraph::load(filePath, CsrGraph::Validate::Full));
+}
+
+} // namespace psa
+
+#endif // PSA_CSRGRAPH_H
@@ -6,15 +6,36 @@
 #ifndef PSA_DIJKSTRAGRAPH_H
 #define PSA_DIJKSTRAGRAPH_H
 
+#include <functional>
 #include <limits>
 #include <vector>
 
 #include "Graph.h"
+#include "SearchContext.h"
 
 namespace psa {
 
 class DijkstraGraphEdge;
 
+/**
+ * Priority queues the shortest path search can run on. RadixHeap and BucketQueue (Dial's
+ * buckets, best for small edge lengths) rely on Dijkstra's popped distances never going down.
+ */
+enum class ShortestPathQueue
+{
+    IndexedHeap,
+    RadixHeap,
+    BucketQueue
+};
+
+// result of a point to point query, path is empty if the target is not reachable
+struct ShortestPath
+{
+    unsigned int distance{std::numeric_limits<unsigned int>::max()};
+    std::vector<vertexid_t> path{};
+    std::size_t nsettled{0}; // vertices settled by the searches
+};
+
 class DijkstraGraphVertex : public Vertex
 {
 public:
@@ -55,7 +76,6 @@ class DijkstraGraph : public Graph<DijkstraGraphVertex, DijkstraGraphEdge>
 {
 public:
     DijkstraGraph() = default;
-    ~DijkstraGraph();
 
     std::size_t nvertices() const override { return m_vertices.size(); }
     std::size_t nedges() const override { return m_edges.size(); }
@@ -64,19 +84,19 @@ public:
 
     void addVertex(vertexid_t id) override
     {
-        auto v = new DijkstraGraphVertex{id};
+        auto v = this->createVertex(id);
         m_vertices.push_back(v);
     }
     edgeid_t addEdge(edgeid_t id, DijkstraGraphVertex* u,
                  DijkstraGraphVertex* v, int length) override
     {
-        auto e = new DijkstraGraphEdge{id, u, v, static_cast<unsigned int>(length)};
+        auto e = this->createEdge(id, u, v, static_cast<unsigned int>(length));
         u->addEdge(e);
         m_edges.push_back(e);
         ++id;
 
         if (this->type() == Type::Undirected) {
-            e = new DijkstraGraphEdge{id, v, u, static_cast<unsigned int>(length)};
+            e = this->createEdge(id, v, u, static_cast<unsigned int>(length));
             v->addEdge(e);
             m_edges.push_back(e);
             ++id;
@@ -86,6 +106,32 @@ public:
     }
 
     void findShortestPath(vertexid_t sourceVertexId);
+    void findShortestPath(vertexid_t sourceVertexId, SearchContext& context,
+                          ShortestPathQueue queue = ShortestPathQueue::IndexedHeap) const;
+
+    static std::vector<unsigned int> findShortestPath(
+            const CsrGraph& graph, vertexid_t sourceVertexId,
+            ShortestPathQueue queue = ShortestPathQueue::IndexedHeap);
+    static void findShortestPath(const CsrGraph& graph, vertexid_t sourceVertexId,
+                                 SearchContext& context,
+                                 ShortestPathQueue queue = ShortestPathQueue::IndexedHeap);
+    static std::vector<unsigned int> findShortestPath(const CsrGraph& graph,
+                                                      vertexid_t sourceVertexId,
+                                                      ThreadPool& pool, unsigned int delta = 0);
+
+    // called once per source with the finished search, concurrently from the pool threads; a
+    // parallel search on the same pool from the callback runs serially on the calling thread
+    using ShortestPathCallback = std::function<void(vertexid_t sourceVertexId,
+                                                    const SearchContext& context)>;
+    static void findShortestPaths(const CsrGraph& graph, const std::vector<vertexid_t>& sources,
+                                  ThreadPool& pool, const ShortestPathCallback& callback,
+                                  ShortestPathQueue queue = ShortestPathQueue::IndexedHeap);
+
+    static ShortestPath shortestPath(const CsrGraph& graph, const CsrGraph& reverse,
+                                     vertexid_t sourceVertexId, vertexid_t targetVertexId);
+    static ShortestPath shortestPath(const CsrGraph& graph, const CsrGraph& reverse,
+                                     vertexid_t sourceVertexId, vertexid_t targetVertexId,
+                                     SearchContext& forward, SearchContext& backward);
 
 private:
     void reserveVertices(std::size_t nvertices) override { m_vertices.reserve(nvertices); }
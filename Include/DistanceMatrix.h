@@ -0,0 +1,75 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_DISTANCEMATRIX_H
+#define PSA_DISTANCEMATRIX_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "GraphTypes.h"
+
+namespace psa {
+
+class CsrGraph;
+class ThreadPool;
+
+/**
+ * DistanceMatrix keeps the distance of every vertex pair of a dense graph, row major with the
+ * rows padded to a multiple of the tile size. findShortestPaths() runs Floyd-Warshall over
+ * kTileSize x kTileSize tiles: for every block k the diagonal tile goes first, then the tiles
+ * of row k and column k in parallel, then all the others in parallel. A tile fits in L1 and
+ * the min-plus inner loop runs over contiguous rows so the compiler can vectorize it.
+ *
+ * Unreachable pairs read back as kInfinity; inside, they are kept at half of that so adding
+ * two of them never overflows.
+ */
+class DistanceMatrix
+{
+public:
+    static const std::size_t kTileSize = 64;
+    static const unsigned int kInfinity = std::numeric_limits<unsigned int>::max();
+
+public:
+    // no edges, 0 on the diagonal
+    explicit DistanceMatrix(std::size_t nvertices);
+
+    // the shortest edge for every adjacent pair
+    static DistanceMatrix fromGraph(const CsrGraph& graph);
+
+    // distance matrix of all the vertex pairs of the graph
+    static DistanceMatrix findShortestPaths(const CsrGraph& graph, ThreadPool& pool);
+
+    std::size_t nvertices() const { return m_nvertices; }
+
+    unsigned int distance(vertexid_t u, vertexid_t v) const
+    {
+        unsigned int d = m_distances[u * m_stride + v];
+        return d >= kUnreachable ? kInfinity : d;
+    }
+    void setDistance(vertexid_t u, vertexid_t v, unsigned int distance)
+    {
+        m_distances[u * m_stride + v] = std::min(distance, kUnreachable);
+    }
+
+    // replaces every distance with the shortest path length
+    void findShortestPaths(ThreadPool& pool);
+
+private:
+    static const unsigned int kUnreachable = kInfinity / 2;
+
+    // tile (i, j) = min(tile (i, j), tile (i, k) + tile (k, j)), k outermost so the tiles may
+    // be the same one
+    void relaxTile(std::size_t i, std::size_t j, std::size_t k);
+
+    std::size_t m_nvertices;
+    std::size_t m_stride; // padded row length, a multiple of kTileSize
+    std::vector<unsigned int> m_distances;
+};
+
+} // namespace psa
+
+#endif // PSA_DISTANCEMATRIX_H
@@ -8,33 +8,20 @@
 
 #include <istream>
 #include <ostream>
-#include <regex>
+#include <sstream>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include <fmt/format.h>
-
-#include "AlgoException.h"
+#include "AdjListParser.h"
+#include "GraphTypes.h"
+#include "MappedFile.h"
+#include "ObjectArena.h"
 
 namespace psa {
 
-using vertexid_t = unsigned int;
-#ifdef WINDOWS
-using edgeid_t = unsigned long long;
-#else
-using edgeid_t = unsigned long;
-#endif // WINDOWS
-
-// Heap indexing function object used for Dijkstra shortest path, Prim's minimum spanning tree
-template<typename VertexType> struct HeapIndex
-{
-    HeapIndex(std::unordered_map<vertexid_t, std::size_t>& map) : m_map{map} {}
-    void operator()(VertexType* element, std::size_t i)
-    {
-        m_map[element->id()] = i;
-    }
-    std::unordered_map<vertexid_t, std::size_t>& m_map;
-};
+class CsrGraph;
+class ThreadPool;
 
 /**
  * Vertex class abstracts Graph vertex. Edges list structure is left to derived
@@ -80,14 +67,16 @@ private:
 };
 
 /**
- * Graph class abstract common behaviors for graph.
+ * Graph class abstract common behaviors for graph. Vertex and edge objects of the derived
+ * classes are created with createVertex()/createEdge() out of arenas owned by the graph, they
+ * are destroyed with the graph and must not be deleted.
  */
 template<typename VertexType, typename EdgeType>
 class Graph
 {
 public:
     static const char kSeparator = '\t';
-    enum class Type { Directed, Undirected };
+    using Type = GraphType;
 
 public:
     Graph() {}
@@ -104,52 +93,95 @@ public:
     virtual edgeid_t addEdge(edgeid_t id, VertexType* u, VertexType* v, int value) = 0;
 
     void readAdjList(std::istream& stream);
+    void readAdjList(const std::string& filePath); // memory maps the file, no copy
+    void readAdjList(const std::string& filePath, ThreadPool& pool); // parses on all threads
     void writeAdjList(std::ostream& stream);
 
+    // defined in CsrGraph.h
+    void readCsr(const CsrGraph& graph);
+    void readCsr(const std::string& filePath);
+
 protected:
     virtual void reserveVertices(std::size_t nvertices) = 0;
     virtual void reserveEdges(std::size_t nedges) = 0;
 
-    void readEdges(std::istream& stream);
+    template<typename... Args> VertexType* createVertex(Args&&... args)
+    {
+        return m_vertexArena.create(std::forward<Args>(args)...);
+    }
+    template<typename... Args> EdgeType* createEdge(Args&&... args)
+    {
+        return m_edgeArena.create(std::forward<Args>(args)...);
+    }
+    // destroys the vertices created after the first nvertices
+    void releaseVertices(std::size_t nvertices) { m_vertexArena.rewind(nvertices); }
+
+    void readAdjList(const char* first, const char* last);
 
 private:
+    void reserve(std::size_t nvertices, std::size_t nedges)
+    {
+        this->reserveVertices(nvertices);
+        this->reserveEdges(nedges);
+
+        m_vertexArena.reserve(nvertices);
+        m_edgeArena.reserve(nedges);
+    }
+
     Type m_type;
+
+    ObjectArena<VertexType> m_vertexArena{};
+    ObjectArena<EdgeType> m_edgeArena{};
 };
 
 template<typename VertexType, typename EdgeType>
 void Graph<VertexType, EdgeType>::readAdjList(std::istream& stream)
 {
-    std::string buf;
-
-    std::getline(stream, buf); // Read type: "directed" or "undirected"
-    if (buf == "directed")
-        m_type = Type::Directed;
-    else if (buf == "undirected")
-        m_type = Type::Undirected;
-    else
-        throw AlgoException{fmt::format(AlgoException::GraphBadFormat,
-                                        "directed or undirected", buf)};
-
-    std::getline(stream, buf); // Read line that has number of vertices and edges.
-
-    std::smatch results;
-    if (!std::regex_search(buf, results, std::regex{R"(^(\d+)(\s+\d+)?)"}))
-        throw AlgoException{fmt::format(AlgoException::GraphBadFormat,
-                                        "number of nodes followed by optional number of edges",
-                                        buf)};
-
-    unsigned int nvertices = std::stoi(results[1]);
-    this->reserveVertices(nvertices);
-    if (results[2].matched) {
-        long nedges = std::stol(results[2]);
-        this->reserveEdges(nedges);
-    }
+    std::ostringstream buf;
+    buf << stream.rdbuf();
+    const std::string& text = buf.str();
+
+    this->readAdjList(text.data(), text.data() + text.size());
+}
+
+template<typename VertexType, typename EdgeType>
+void Graph<VertexType, EdgeType>::readAdjList(const std::string& filePath)
+{
+    MappedFile file{filePath};
+    this->readAdjList(file.begin(), file.end());
+}
+
+/**
+ * Tokenizes the file on all the threads of the pool, the edges are then added in file order,
+ * so the graph is the same as the one read on a single thread.
+ */
+template<typename VertexType, typename EdgeType>
+void Graph<VertexType, EdgeType>::readAdjList(const std::string& filePath, ThreadPool& pool)
+{
+    MappedFile file{filePath};
+
+    AdjListParser parser{file.begin(), file.end()};
+    parser.parseHeader();
+
+    m_type = parser.type();
+
+    std::vector<std::vector<CsrEdge>> chunks = parser.parseEdges(pool);
+
+    std::size_t nedges = 0;
+    for (auto& chunk : chunks)
+        nedges += chunk.size();
+
+    std::size_t nvertices = parser.nvertices();
+    this->reserve(nvertices, nedges);
 
-    // Create all vertices and add to graph
     for (vertexid_t i = 0; i < nvertices; ++i)
         this->addVertex(i);
 
-    this->readEdges(stream);
+    edgeid_t edgeid{0};
+    for (auto& chunk : chunks) {
+        for (auto& e : chunk)
+            edgeid = this->addEdge(edgeid, this->vertex(e.u), this->vertex(e.v), e.value);
+    }
 }
 
 template<typename VertexType, typename EdgeType>
@@ -157,50 +189,32 @@ void Graph<VertexType, EdgeType>::writeAdjList(std::ostream& stream)
 {
     std::size_t nvertices = this->nvertices();
 
+    stream << (m_type == Type::Directed ? "directed" : "undirected") << std::endl;
     stream << nvertices << kSeparator << this->nedges() << std::endl;
 
-    for (std::size_t id = 1; id <= nvertices; ++id)
+    for (vertexid_t id = 0; id < nvertices; ++id)
         stream << this->vertex(id)->toString() << '\n';
 }
 
 template<typename VertexType, typename EdgeType>
-void Graph<VertexType, EdgeType>::readEdges(std::istream& stream)
+void Graph<VertexType, EdgeType>::readAdjList(const char* first, const char* last)
 {
-    auto pattern = std::regex{R"(\s+)"};
-
-    edgeid_t edgeid{0};
-    int value{};
-
-    std::string buf;
-    while (!stream.eof()) {
-        std::getline(stream, buf);
-        if (buf.size() == 0) // empty string
-            continue;
-
-        auto it = std::sregex_token_iterator{buf.begin(), buf.end(), pattern, -1};
-        const std::sregex_token_iterator endIt{};
+    AdjListParser parser{first, last};
+    parser.parseHeader();
 
-        int id = std::stoi(it->str());
-        VertexType* u = this->vertex(id);
+    m_type = parser.type();
 
-        std::string str{};
-        for (++it; it != endIt; ++it) {
-            str = it->str();
+    std::size_t nvertices = parser.nvertices();
+    this->reserve(nvertices, parser.nedges());
 
-            std::size_t i = str.find(",");
-            if (i != std::string::npos) {
-                id = std::stoi(str.substr(0, i));
-                value = std::stoi(str.substr(i+1));
-            } else {
-                id = std::stoi(it->str());
-                value = 0;
-            }
-
-            VertexType* v = this->vertex(id);
+    // Create all vertices and add to graph
+    for (vertexid_t i = 0; i < nvertices; ++i)
+        this->addVertex(i);
 
-            edgeid = this->addEdge(edgeid, u, v, value);
-        }
-    }
+    edgeid_t edgeid{0};
+    parser.parseEdges([this, &edgeid](vertexid_t u, vertexid_t v, int value) {
+        edgeid = this->addEdge(edgeid, this->vertex(u), this->vertex(v), value);
+    });
 }
 
 } // namespace psa
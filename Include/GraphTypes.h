@@ -0,0 +1,24 @@
+/**
+ * Header file for the basic types shared by the graph classes
+ *
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_GRAPHTYPES_H
+#define PSA_GRAPHTYPES_H
+
+namespace psa {
+
+using vertexid_t = unsigned int;
+#ifdef WINDOWS
+using edgeid_t = unsigned long long;
+#else
+using edgeid_t = unsigned long;
+#endif // WINDOWS
+
+enum class GraphType { Directed, Undirected };
+
+} // namespace psa
+
+#endif // PSA_GRAPHTYPES_H
@@ -0,0 +1,186 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_INDEXEDMINHEAP_H
+#define PSA_INDEXEDMINHEAP_H
+
+#include <limits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "GraphTypes.h"
+
+namespace psa {
+
+/**
+ * IndexedMinHeap is a d-ary min heap of (key, id) pairs where every id is in the heap at most
+ * once. The heap position of every id is kept in a dense array, so contains() and
+ * decreaseKey() are O(1) lookups and moving an entry costs one array store.
+ *
+ * Ids must be in [0, capacity()), see reset(). Entries are kept inline and compared by key
+ * only, the wider Arity makes the heap shallower at the cost of more compares per level.
+ */
+template<typename Key, unsigned int Arity = 4>
+class IndexedMinHeap
+{
+    static_assert(Arity >= 2, "IndexedMinHeap needs at least two children per node");
+
+public:
+    static const vertexid_t kNoPosition = std::numeric_limits<vertexid_t>::max();
+
+    struct Entry
+    {
+        Key key;
+        vertexid_t id;
+    };
+
+public:
+    IndexedMinHeap() = default;
+    explicit IndexedMinHeap(std::size_t capacity) { this->reset(capacity); }
+
+    // empties the heap and makes room for the ids [0, capacity)
+    void reset(std::size_t capacity);
+    void clear();
+
+    std::size_t capacity() const { return m_position.size(); }
+    std::size_t size() const { return m_heap.size(); }
+    bool isEmpty() const { return m_heap.empty(); }
+    bool contains(vertexid_t id) const { return m_position[id] != kNoPosition; }
+
+    const Entry& top() const { return m_heap.front(); }
+    Key key(vertexid_t id) const { return m_heap[m_position[id]].key; }
+
+    void push(vertexid_t id, Key key) { this->siftup(m_heap.size(), Entry{key, id}); }
+    // throws if key is larger than the key id has
+    void decreaseKey(vertexid_t id, Key key);
+
+    // inserts id or lowers its key, @return false if id is in the heap with a key <= key
+    bool pushOrDecrease(vertexid_t id, Key key)
+    {
+        vertexid_t i = m_position[id];
+        if (i == kNoPosition) {
+            this->siftup(m_heap.size(), Entry{key, id});
+            return true;
+        }
+        if (!(key < m_heap[i].key))
+            return false;
+
+        this->siftup(i, Entry{key, id});
+        return true;
+    }
+
+    Entry pop();
+
+private:
+    void siftup(std::size_t i, Entry entry);
+    void siftdown(std::size_t i, Entry entry);
+
+    void place(std::size_t i, const Entry& entry)
+    {
+        m_heap[i] = entry;
+        m_position[entry.id] = static_cast<vertexid_t>(i);
+    }
+
+    std::vector<Entry> m_heap{};
+    std::vector<vertexid_t> m_position{};
+};
+
+template<typename Key, unsigned int Arity>
+const vertexid_t IndexedMinHeap<Key, Arity>::kNoPosition;
+
+template<typename Key, unsigned int Arity>
+void IndexedMinHeap<Key, Arity>::reset(std::size_t capacity)
+{
+    this->clear();
+    if (capacity > m_position.size())
+        m_position.resize(capacity, kNoPosition);
+}
+
+template<typename Key, unsigned int Arity>
+void IndexedMinHeap<Key, Arity>::clear()
+{
+    for (auto& entry : m_heap)
+        m_position[entry.id] = kNoPosition;
+    m_heap.clear();
+}
+
+template<typename Key, unsigned int Arity>
+void IndexedMinHeap<Key, Arity>::decreaseKey(vertexid_t id, Key key)
+{
+    if (id >= m_position.size() || m_position[id] == kNoPosition)
+        throw AlgoException{fmt::format(AlgoException::HeapIdNotFound, id)};
+    if (m_heap[m_position[id]].key < key)
+        throw AlgoException{fmt::format(AlgoException::HeapKeyIncreased, id)};
+
+    this->siftup(m_position[id], Entry{key, id});
+}
+
+template<typename Key, unsigned int Arity>
+typename IndexedMinHeap<Key, Arity>::Entry IndexedMinHeap<Key, Arity>::pop()
+{
+    if (m_heap.empty())
+        throw AlgoException{AlgoException::HeapEmpty};
+
+    Entry top = m_heap.front();
+    m_position[top.id] = kNoPosition;
+
+    Entry last = m_heap.back();
+    m_heap.pop_back();
+    if (!m_heap.empty())
+        this->siftdown(0, last);
+
+    return top;
+}
+
+// moves the hole at i up until entry fits, i == size() appends
+template<typename Key, unsigned int Arity>
+void IndexedMinHeap<Key, Arity>::siftup(std::size_t i, Entry entry)
+{
+    if (i == m_heap.size())
+        m_heap.push_back(entry);
+
+    while (i > 0) {
+        std::size_t parent = (i - 1) / Arity;
+        if (!(entry.key < m_heap[parent].key))
+            break;
+        this->place(i, m_heap[parent]);
+        i = parent;
+    }
+
+    this->place(i, entry);
+}
+
+// moves the hole at i down until entry fits
+template<typename Key, unsigned int Arity>
+void IndexedMinHeap<Key, Arity>::siftdown(std::size_t i, Entry entry)
+{
+    const std::size_t n = m_heap.size();
+
+    for (;;) {
+        std::size_t first = i * Arity + 1;
+        if (first >= n)
+            break;
+
+        std::size_t last = first + Arity < n ? first + Arity : n;
+        std::size_t smallest = first;
+        for (std::size_t c = first + 1; c < last; ++c) {
+            if (m_heap[c].key < m_heap[smallest].key)
+                smallest = c;
+        }
+
+        if (!(m_heap[smallest].key < entry.key))
+            break;
+        this->place(i, m_heap[smallest]);
+        i = smallest;
+    }
+
+    this->place(i, entry);
+}
+
+} // namespace psa
+
+#endif // PSA_INDEXEDMINHEAP_H
@@ -33,7 +33,6 @@ public:
     KargerMinCutGraph() = default;
     KargerMinCutGraph(const KargerMinCutGraph& rhs);
     KargerMinCutGraph(KargerMinCutGraph&& rhs) = delete;
-    ~KargerMinCutGraph();
 
     KargerMinCutGraph& operator=(const KargerMinCutGraph& rhs) = delete;
     KargerMinCutGraph& operator=(KargerMinCutGraph&& rhs) = delete;
@@ -45,19 +44,19 @@ public:
 
     void addVertex(vertexid_t id) override
     {
-        auto v = new KargerMinCutGraphVertex{id};
+        auto v = this->createVertex(id);
         m_vertices.push_back(v);
     }
     edgeid_t addEdge(edgeid_t id, KargerMinCutGraphVertex* u,
                  KargerMinCutGraphVertex* v, int /*value*/) override
     {
-        auto e = new Edge<KargerMinCutGraphVertex>{id, u, v};
+        auto e = this->createEdge(id, u, v);
         u->addEdge(e);
         m_edges.push_back(e);
         ++id;
 
         if (this->type() == Type::Undirected) {
-            e = new Edge<KargerMinCutGraphVertex>{id, v, u};
+            e = this->createEdge(id, v, u);
             v->addEdge(e);
             m_edges.push_back(e);
             ++id;
@@ -6,27 +6,27 @@
 #ifndef PSA_KRUSKALMINSPANNINGGRAPH_H
 #define PSA_KRUSKALMINSPANNINGGRAPH_H
 
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
 #include "Graph.h"
 
 namespace psa {
 
+// single-linkage clusters: the dense cluster number of every vertex (or point), and the least
+// cost of an edge between two clusters, KruskalMinSpanningGraph::kNoSpacing if there is none
+struct Clustering
+{
+    std::vector<unsigned int> labels;
+    int spacing;
+};
+
 class KruskalMinSpanningGraphVertex : public Vertex
 {
 public:
-    KruskalMinSpanningGraphVertex(vertexid_t id)
-        : Vertex{id}
-        , m_leader{this}
-    {}
-
-    KruskalMinSpanningGraphVertex* leader() const { return m_leader; }
-    int rank() const { return m_rank; }
-
-    void setLeader(KruskalMinSpanningGraphVertex* leader) { m_leader = leader; }
-    void setRank(int rank) { m_rank = rank; }
-
-private:
-    KruskalMinSpanningGraphVertex* m_leader;
-    int m_rank{0};
+    KruskalMinSpanningGraphVertex(vertexid_t id) : Vertex{id} {}
 };
 
 class KruskalMinSpanningGraphEdge : public Edge<KruskalMinSpanningGraphVertex>
@@ -47,9 +47,13 @@ private:
 class KruskalMinSpanningGraph :
     public Graph<KruskalMinSpanningGraphVertex, KruskalMinSpanningGraphEdge>
 {
+public:
+    static const int kNoSpacing = std::numeric_limits<int>::max();
+    static const std::size_t kMinMemoryBudget = 1 << 14;
+    static const std::size_t kIoBufferSize = 1 << 20;
+
 public:
     KruskalMinSpanningGraph() = default;
-    ~KruskalMinSpanningGraph();
 
     std::size_t nvertices() const override { return m_vertices.size(); }
     std::size_t nedges() const override { return m_edges.size(); }
@@ -59,13 +63,13 @@ public:
 
     void addVertex(vertexid_t id) override
     {
-        auto v = new KruskalMinSpanningGraphVertex{id};
+        auto v = this->createVertex(id);
         m_vertices.push_back(v);
     }
     edgeid_t addEdge(edgeid_t id, KruskalMinSpanningGraphVertex* u,
                      KruskalMinSpanningGraphVertex* v, int cost) override
     {
-        auto e = new KruskalMinSpanningGraphEdge{id, u, v, cost};
+        auto e = this->createEdge(id, u, v, cost);
         m_edges.push_back(e);
         ++id;
 
@@ -73,14 +77,52 @@ public:
     }
 
     long findMst();
+    static long findMst(const CsrGraph& graph);
+
+    /**
+     * Filter-Kruskal: the edges are split around a sampled pivot cost, the light part is done
+     * first and the heavy part loses its edges inside a component before it gets sorted. Small
+     * parts are sorted with the parallel radix sort; the split and the filter are parallel
+     * partitions on the pool as well.
+     */
+    static long findMst(const CsrGraph& graph, ThreadPool& pool);
+
+    /**
+     * Kruskal's loop stopped at k clusters, k in [1, nvertices]. The edges are kept in a heap
+     * rather than sorted, so only the ones taken out before the stop are ordered. A graph with
+     * more than k connected components ends up with all of them as clusters.
+     */
+    Clustering cluster(std::size_t k);
+    int maxSpacing(std::size_t k);
+    static Clustering cluster(const CsrGraph& graph, std::size_t k);
+    static int maxSpacing(const CsrGraph& graph, std::size_t k);
+
+    /**
+     * Same for points given as nbits wide codes, at most 32, with their Hamming distance as the
+     * edge cost. The edges are never stored: for every distance d, from 0 up, each point looks
+     * up the codes that differ from its own in exactly d bits, the masks made by Gosper's hack.
+     * That is C(nbits, d) lookups per point, so it suits a spacing of a few bits.
+     */
+    static Clustering clusterHamming(const std::vector<std::uint32_t>& codes, unsigned int nbits,
+                                     std::size_t k);
+
+    /**
+     * External memory Kruskal over an edge list file too big for memory: a "nvertices [nedges]"
+     * line, then one "u v cost" line per edge with the vertices counted from 1, costs in the int
+     * range. The file is read in chunks of memoryBudget bytes, every chunk is sorted and appended
+     * as a run to a temporary file in tempDirectory (removed when done), then the sorted runs are
+     * merged into the union-find, kIoBufferSize per run and as many passes as the budget needs,
+     * with never more than two files open. The merge stops as soon as all the vertices are
+     * connected. The files are read and written a whole buffer at a time; only the union-find,
+     * 8 bytes per vertex, is outside the budget, which is at least kMinMemoryBudget.
+     */
+    static long findMstExternal(const std::string& edgeListPath, std::size_t memoryBudget,
+                                const std::string& tempDirectory = ".");
 
 private:
     void reserveVertices(std::size_t nvertices) override { m_vertices.reserve(nvertices); }
     void reserveEdges(std::size_t nedges) override { m_edges.reserve(nedges); }
 
-    KruskalMinSpanningGraphVertex* findLeader(KruskalMinSpanningGraphVertex* vertex);
-    void unionLeaders(KruskalMinSpanningGraphVertex* u, KruskalMinSpanningGraphVertex* v);
-
     std::vector<KruskalMinSpanningGraphVertex*> m_vertices{};
     std::vector<KruskalMinSpanningGraphEdge*> m_edges{};
 };
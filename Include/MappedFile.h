@@ -0,0 +1,56 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_MAPPEDFILE_H
+#define PSA_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace psa {
+
+/**
+ * MappedFile maps a whole file into memory. The mapping is released when the object goes out
+ * of scope. Existing files are mapped read only. The size constructor maps a new file next to
+ * filePath for writing with its blocks allocated up front; commit() when done writing puts it
+ * in place of filePath and throws on write back errors, otherwise it is removed on destruction.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const std::string& filePath);
+    MappedFile(const std::string& filePath, std::size_t size); // replace on commit()
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile(MappedFile&& rhs);
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+    MappedFile& operator=(MappedFile&& rhs);
+
+    const std::string& filePath() const { return m_filePath; }
+    const char* data() const { return m_data; }
+    char* data() { return m_data; }
+    std::size_t size() const { return m_size; }
+
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+    void commit();
+
+private:
+    void unmap();
+    void discard();
+
+    std::string m_filePath{};
+    std::string m_tmpPath{}; // written and renamed to m_filePath on commit()
+    char* m_data{nullptr};
+    std::size_t m_size{0};
+    int m_fd{-1}; // of the file being written, -1 once committed or if read only
+};
+
+} // namespace psa
+
+#endif // PSA_MAPPEDFILE_H
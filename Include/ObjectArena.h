@@ -0,0 +1,126 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_OBJECTARENA_H
+#define PSA_OBJECTARENA_H
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace psa {
+
+/**
+ * ObjectArena is a bump allocator for objects of one type. Objects are constructed in place
+ * in large blocks, so creating one is a pointer bump. All objects are destroyed and the blocks
+ * freed together when the arena goes away; objects can't be deleted one by one, but the most
+ * recently created ones can be released with rewind().
+ */
+template<typename T>
+class ObjectArena
+{
+public:
+    static const std::size_t kMinBlockSize = 1024;
+
+public:
+    ObjectArena() = default;
+    ObjectArena(const ObjectArena& rhs) = delete;
+    ~ObjectArena();
+
+    ObjectArena& operator=(const ObjectArena& rhs) = delete;
+
+    std::size_t size() const { return m_size; }
+
+    // make sure next n objects need at most one more block
+    void reserve(std::size_t n)
+    {
+        std::size_t available = m_capacity - m_size;
+        if (n > available)
+            m_nextBlockSize = std::max(m_nextBlockSize, n - available);
+    }
+
+    template<typename... Args> T* create(Args&&... args)
+    {
+        if (m_current == m_blocks.size() || m_blocks[m_current].used == m_blocks[m_current].capacity)
+            this->nextBlock();
+
+        Block& block = m_blocks[m_current];
+        T* object = new (block.data + block.used) T(std::forward<Args>(args)...);
+        ++block.used;
+        ++m_size;
+        return object;
+    }
+
+    // destroys the objects created after the first n, the memory is kept for reuse
+    void rewind(std::size_t n);
+
+private:
+    struct Block
+    {
+        T* data;
+        std::size_t capacity;
+        std::size_t used;
+    };
+
+    void nextBlock();
+
+    std::vector<Block> m_blocks{};
+    std::size_t m_current{0};
+    std::size_t m_size{0};
+    std::size_t m_capacity{0};
+    std::size_t m_nextBlockSize{kMinBlockSize};
+};
+
+template<typename T>
+ObjectArena<T>::~ObjectArena()
+{
+    this->rewind(0);
+
+    for (auto& block : m_blocks)
+        ::operator delete(block.data);
+}
+
+template<typename T>
+void ObjectArena<T>::rewind(std::size_t n)
+{
+    while (m_size > n) {
+        Block& block = m_blocks[m_current];
+        std::size_t count = std::min(block.used, m_size - n);
+
+        if (!std::is_trivially_destructible<T>::value) {
+            for (std::size_t i = block.used; i > block.used - count; --i)
+                block.data[i - 1].~T();
+        }
+
+        block.used -= count;
+        m_size -= count;
+
+        if (block.used == 0 && m_current > 0)
+            --m_current;
+    }
+}
+
+template<typename T>
+void ObjectArena<T>::nextBlock()
+{
+    if (m_current < m_blocks.size() && m_blocks[m_current].used > 0)
+        ++m_current;
+
+    if (m_current < m_blocks.size()) // reuse block kept by rewind()
+        return;
+
+    std::size_t capacity = std::max(m_nextBlockSize, m_capacity); // grow geometrically
+    T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+    m_blocks.push_back(Block{data, capacity, 0});
+    m_current = m_blocks.size() - 1;
+    m_capacity += capacity;
+    m_nextBlockSize = kMinBlockSize;
+}
+
+} // namespace psa
+
+#endif // PSA_OBJECTARENA_H
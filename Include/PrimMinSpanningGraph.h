@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "Graph.h"
+#include "SearchContext.h"
 
 namespace psa {
 
@@ -54,7 +55,6 @@ class PrimMinSpanningGraph : public Graph<PrimMinSpanningGraphVertex, PrimMinSpa
 {
 public:
     PrimMinSpanningGraph() = default;
-    ~PrimMinSpanningGraph();
 
     std::size_t nvertices() const override { return m_vertices.size(); }
     std::size_t nedges() const override { return m_edges.size(); }
@@ -63,19 +63,19 @@ public:
 
     void addVertex(vertexid_t id) override
     {
-        auto v = new PrimMinSpanningGraphVertex{id};
+        auto v = this->createVertex(id);
         m_vertices.push_back(v);
     }
     edgeid_t addEdge(edgeid_t id, PrimMinSpanningGraphVertex* u,
                      PrimMinSpanningGraphVertex* v, int cost) override
     {
-        auto e = new PrimMinSpanningGraphEdge{id, u, v, cost};
+        auto e = this->createEdge(id, u, v, cost);
         u->addEdge(e);
         m_edges.push_back(e);
         ++id;
 
         if (this->type() == Type::Undirected) {
-            e = new PrimMinSpanningGraphEdge{id, v, u, cost};
+            e = this->createEdge(id, v, u, cost);
             v->addEdge(e);
             m_edges.push_back(e);
             ++id;
@@ -85,6 +85,8 @@ public:
     }
 
     long findMst();
+    static long findMst(const CsrGraph& graph);
+    static long findMst(const CsrGraph& graph, BasicSearchContext<int>& context);
 
 private:
     void reserveVertices(std::size_t nvertices) override { m_vertices.reserve(nvertices); }
@@ -0,0 +1,129 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_RADIXHEAP_H
+#define PSA_RADIXHEAP_H
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "GraphTypes.h"
+
+namespace psa {
+
+/**
+ * RadixHeap is a monotone priority queue of (key, id) pairs with unsigned integer keys: a key
+ * pushed must not be smaller than the last key popped, which holds for Dijkstra's distances.
+ *
+ * Entry with key k is kept in bucket b(k), the bit length of k ^ last, so bucket 0 holds the
+ * keys equal to the last popped one. When bucket 0 runs dry the first non empty bucket is
+ * spread out over the lower buckets around its minimum; every entry moves to a lower bucket
+ * each time, that bounds the work per entry by the key width.
+ *
+ * There is no decreaseKey, the same id is pushed again and the caller skips stale entries.
+ */
+template<typename Key>
+class RadixHeap
+{
+    static_assert(std::is_unsigned<Key>::value, "RadixHeap needs unsigned integer keys");
+
+public:
+    static const unsigned int kBuckets = std::numeric_limits<Key>::digits + 1;
+
+    struct Entry
+    {
+        Key key;
+        vertexid_t id;
+    };
+
+public:
+    RadixHeap() = default;
+
+    std::size_t size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    void push(vertexid_t id, Key key)
+    {
+        if (key < m_last)
+            throw AlgoException{fmt::format(AlgoException::HeapKeyNotMonotone, key, m_last)};
+
+        m_buckets[this->bucket(key)].push_back(Entry{key, id});
+        ++m_size;
+    }
+
+    Entry pop();
+    void clear();
+
+private:
+    unsigned int bucket(Key key) const { return key == m_last ? 0 : bitLength(key ^ m_last); }
+
+    static unsigned int bitLength(Key x)
+    {
+#if defined(__GNUC__)
+        if (sizeof(Key) <= sizeof(unsigned int))
+            return std::numeric_limits<unsigned int>::digits
+                    - __builtin_clz(static_cast<unsigned int>(x));
+        return std::numeric_limits<unsigned long long>::digits
+                - __builtin_clzll(static_cast<unsigned long long>(x));
+#else
+        unsigned int n = 0;
+        for (; x != 0; x >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+
+    std::array<std::vector<Entry>, kBuckets> m_buckets{};
+    Key m_last{0};
+    std::size_t m_size{0};
+};
+
+template<typename Key>
+typename RadixHeap<Key>::Entry RadixHeap<Key>::pop()
+{
+    if (m_size == 0)
+        throw AlgoException{AlgoException::HeapEmpty};
+
+    if (m_buckets[0].empty()) {
+        unsigned int i = 1;
+        while (m_buckets[i].empty())
+            ++i;
+
+        std::vector<Entry>& spread = m_buckets[i];
+        m_last = std::min_element(spread.begin(), spread.end(),
+                                  [](const Entry& lhs, const Entry& rhs) {
+                                      return lhs.key < rhs.key; })->key;
+
+        // every entry lands in a bucket below i
+        for (auto& entry : spread)
+            m_buckets[this->bucket(entry.key)].push_back(entry);
+        spread.clear();
+    }
+
+    Entry entry = m_buckets[0].back();
+    m_buckets[0].pop_back();
+    --m_size;
+
+    return entry;
+}
+
+template<typename Key>
+void RadixHeap<Key>::clear()
+{
+    for (auto& bucket : m_buckets)
+        bucket.clear();
+    m_last = 0;
+    m_size = 0;
+}
+
+} // namespace psa
+
+#endif // PSA_RADIXHEAP_H
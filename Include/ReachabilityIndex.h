@@ -0,0 +1,65 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_REACHABILITYINDEX_H
+#define PSA_REACHABILITYINDEX_H
+
+#include <vector>
+
+#include "CsrGraph.h"
+#include "GraphTypes.h"
+#include "SearchContext.h"
+
+namespace psa {
+
+/**
+ * ReachabilityIndex answers "does u reach v" on a directed graph. The graph is condensed to the
+ * DAG of its strongly connected components, each component gets its topological position and
+ * GRAIL interval labels: one per randomized depth first traversal of the DAG, [lowest post
+ * order number below the component, its own post order number]. If u reaches v the labels of
+ * v nest in those of u, so most negative queries are answered from the labels alone; the rest
+ * run a depth first search that skips every component whose labels rule it out.
+ */
+class ReachabilityIndex
+{
+public:
+    static const std::size_t kDefaultLabels = 3;
+
+public:
+    ReachabilityIndex() = default;
+    ReachabilityIndex(const ReachabilityIndex& rhs) = delete;
+    ReachabilityIndex(ReachabilityIndex&& rhs) = default;
+
+    ReachabilityIndex& operator=(const ReachabilityIndex& rhs) = delete;
+    ReachabilityIndex& operator=(ReachabilityIndex&& rhs) = default;
+
+    static ReachabilityIndex build(const CsrGraph& graph, std::size_t nlabels = kDefaultLabels,
+                                   unsigned int seed = 0);
+
+    std::size_t nvertices() const { return m_components.size(); }
+    std::size_t nlabels() const { return m_nlabels; }
+    const CsrGraph& dag() const { return m_dag; }
+    unsigned int component(vertexid_t v) const { return m_components[v]; }
+    // position of the component in the topological order of the dag
+    vertexid_t position(unsigned int component) const { return m_positions[component]; }
+
+    bool reaches(vertexid_t u, vertexid_t v) const;
+    bool reaches(vertexid_t u, vertexid_t v, SearchContext& context) const;
+
+private:
+    // the labels of component b nest in those of a, and b is not before a
+    bool mayReach(unsigned int a, unsigned int b) const;
+
+    std::size_t m_nlabels{0};
+    std::vector<unsigned int> m_components{};
+    CsrGraph m_dag{};
+    std::vector<vertexid_t> m_positions{};
+    std::vector<unsigned int> m_low{};  // component major, m_low[c * nlabels + i]
+    std::vector<unsigned int> m_rank{}; // likewise
+};
+
+} // namespace psa
+
+#endif // PSA_REACHABILITYINDEX_H
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_SEARCHCONTEXT_H
+#define PSA_SEARCHCONTEXT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "GraphTypes.h"
+#include "IndexedMinHeap.h"
+
+namespace psa {
+
+/**
+ * SearchContext holds the per query state of a graph search in dense arrays indexed by vertex
+ * id, so the graph itself stays read only and can be searched from many threads at once, each
+ * thread with its own context.
+ *
+ * Every entry carries the epoch it was written in; reset() starts a new query by bumping the
+ * epoch, entries of older queries read as unreached. A context is reused across queries
+ * without touching the arrays, they are cleared only when they grow or the epoch wraps.
+ */
+template<typename Distance>
+class BasicSearchContext
+{
+public:
+    static const Distance kInfinity = std::numeric_limits<Distance>::max();
+    static const vertexid_t kNoVertex = std::numeric_limits<vertexid_t>::max();
+
+public:
+    BasicSearchContext() = default;
+    explicit BasicSearchContext(std::size_t nvertices) { this->reset(nvertices); }
+
+    // starts a new query over a graph of nvertices vertices
+    void reset(std::size_t nvertices);
+
+    std::size_t nvertices() const { return m_nvertices; }
+    std::uint32_t epoch() const { return m_epoch; }
+
+    bool isReached(vertexid_t v) const { return m_reached[v] == m_epoch; }
+    bool isSettled(vertexid_t v) const { return m_settled[v] == m_epoch; }
+    Distance distance(vertexid_t v) const { return this->isReached(v) ? m_distance[v] : kInfinity; }
+    vertexid_t parent(vertexid_t v) const { return this->isReached(v) ? m_parent[v] : kNoVertex; }
+
+    void reach(vertexid_t v, Distance distance, vertexid_t parent)
+    {
+        m_reached[v] = m_epoch;
+        m_distance[v] = distance;
+        m_parent[v] = parent;
+    }
+    void settle(vertexid_t v) { m_settled[v] = m_epoch; }
+
+    // scratch vertex buffer for queues and stacks, cleared by reset()
+    std::vector<vertexid_t>& queue() { return m_queue; }
+    // priority queue over the vertex ids, emptied by reset()
+    IndexedMinHeap<Distance>& heap() { return m_heap; }
+    const IndexedMinHeap<Distance>& heap() const { return m_heap; }
+
+    // distances of all the vertices, kInfinity for the unreached ones
+    std::vector<Distance> distances() const;
+
+    // vertices from the source to v following the parents, empty if v is not reached
+    std::vector<vertexid_t> path(vertexid_t v) const;
+
+private:
+    std::size_t m_nvertices{0};
+    std::uint32_t m_epoch{0};
+
+    std::vector<std::uint32_t> m_reached{};
+    std::vector<std::uint32_t> m_settled{};
+    std::vector<Distance> m_distance{};
+    std::vector<vertexid_t> m_parent{};
+    std::vector<vertexid_t> m_queue{};
+    IndexedMinHeap<Distance> m_heap{};
+};
+
+using SearchContext = BasicSearchContext<unsigned int>;
+
+template<typename Distance>
+const Distance BasicSearchContext<Distance>::kInfinity;
+
+template<typename Distance>
+const vertexid_t BasicSearchContext<Distance>::kNoVertex;
+
+template<typename Distance>
+void BasicSearchContext<Distance>::reset(std::size_t nvertices)
+{
+    if (nvertices > m_reached.size() || ++m_epoch == 0) {
+        m_reached.assign(std::max(nvertices, m_reached.size()), 0);
+        m_settled.assign(m_reached.size(), 0);
+        m_distance.resize(m_reached.size());
+        m_parent.resize(m_reached.size());
+        m_epoch = 1;
+    }
+
+    m_nvertices = nvertices;
+    m_queue.clear();
+    m_heap.reset(nvertices);
+}
+
+template<typename Distance>
+std::vector<Distance> BasicSearchContext<Distance>::distances() const
+{
+    std::vector<Distance> distances(m_nvertices);
+    for (vertexid_t v = 0; v < m_nvertices; ++v)
+        distances[v] = this->distance(v);
+    return distances;
+}
+
+template<typename Distance>
+std::vector<vertexid_t> BasicSearchContext<Distance>::path(vertexid_t v) const
+{
+    std::vector<vertexid_t> path;
+    if (!this->isReached(v))
+        return path;
+
+    for (; v != kNoVertex; v = m_parent[v])
+        path.push_back(v);
+    std::reverse(path.begin(), path.end());
+
+    return path;
+}
+
+} // namespace psa
+
+#endif // PSA_SEARCHCONTEXT_H
@@ -8,8 +8,13 @@
 #ifndef PSA_SORTING_H
 #define PSA_SORTING_H
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <vector>
 
+#include "ThreadPool.h"
+
 namespace psa {
 
 void insertionSort(std::vector<int>& a);
@@ -24,6 +29,62 @@ std::ptrdiff_t quickSort(std::vector<int>& a);
 std::ptrdiff_t randomizedQuickSort(int* p, int* r);
 std::ptrdiff_t randomizedQuickSort(std::vector<int>& a);
 
+// maps an int to an unsigned key of the same order, the sign bit flipped
+inline std::uint32_t radixKey(int value)
+{
+    return static_cast<std::uint32_t>(value) ^ 0x80000000u;
 }
 
+/**
+ * Stable LSD radix sort of records by the 32-bit key(record), a byte per pass. Every pass the
+ * threads count the bytes of their chunk, the counts are prefix summed bucket by bucket and
+ * then chunk by chunk, and every thread scatters its chunk to its own offsets. A pass where
+ * all the records have the same byte is skipped.
+ */
+template<typename Record, typename Key>
+void radixSort(std::vector<Record>& records, Key key, ThreadPool& pool)
+{
+    const std::size_t n = records.size();
+    const std::size_t kGrain = 4096;
+    std::vector<Record> buffer(n);
+    std::vector<std::array<std::size_t, 256>> counts(pool.size());
+
+    for (unsigned int shift = 0; shift < 32; shift += 8) {
+        auto countDigits = [&records, &key, &counts, shift](std::size_t task, std::size_t first,
+                                                            std::size_t last) {
+            std::array<std::size_t, 256>& count = counts[task];
+            count.fill(0);
+            for (std::size_t i = first; i < last; ++i)
+                ++count[(key(records[i]) >> shift) & 0xff];
+        };
+        const std::size_t ntasks = pool.parallelForChunks(n, countDigits, kGrain);
+
+        std::size_t offset = 0;
+        bool isSorted = false;
+        for (std::size_t digit = 0; digit < 256; ++digit) {
+            std::size_t total = 0;
+            for (std::size_t task = 0; task < ntasks; ++task) {
+                std::size_t count = counts[task][digit];
+                counts[task][digit] = offset + total;
+                total += count;
+            }
+            isSorted = isSorted || total == n;
+            offset += total;
+        }
+        if (isSorted)
+            continue;
+
+        // the same chunks as counted, so each one finds its own offsets
+        pool.parallelForChunks(n, [&records, &buffer, &key, &counts, shift](
+                std::size_t task, std::size_t first, std::size_t last) {
+            std::array<std::size_t, 256>& next = counts[task];
+            for (std::size_t i = first; i < last; ++i)
+                buffer[next[(key(records[i]) >> shift) & 0xff]++] = records[i];
+        }, kGrain);
+        records.swap(buffer);
+    }
+}
+
+} // namespace psa
+
 #endif // PSA_SORTING_H
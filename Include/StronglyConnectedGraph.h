@@ -6,7 +6,6 @@
 #ifndef PSA_STRONGLYCONNECTEDGRAPH_H
 #define PSA_STRONGLYCONNECTEDGRAPH_H
 
-#include <unordered_map>
 #include <vector>
 
 #include "Graph.h"
@@ -18,28 +17,12 @@ class StronglyConnectedGraphVertex : public Vertex
 public:
     StronglyConnectedGraphVertex(vertexid_t id) : Vertex{id} {}
 
-    bool explored() const { return m_explored; }
-    int finishTime() const { return m_finishTime; }
-    StronglyConnectedGraphVertex* leader() const { return m_leader; }
     const std::vector<Edge<StronglyConnectedGraphVertex>*>& edges() const { return m_edges; }
-    const std::vector<Edge<StronglyConnectedGraphVertex>*>& reverseEdges() const
-    {
-        return m_reverseEdges;
-    }
-
-    void setExplored(bool explored) { m_explored = explored; }
-    void setFinishTime(int time) { m_finishTime = time; }
-    void setLeader(StronglyConnectedGraphVertex* leader) { m_leader = leader; }
 
     void addEdge(Edge<StronglyConnectedGraphVertex>* e) { m_edges.push_back(e); }
-    void addReverseEdge(Edge<StronglyConnectedGraphVertex>* e) { m_reverseEdges.push_back(e); }
 
 private:
-    bool m_explored{false};
-    int m_finishTime{-1};
-    StronglyConnectedGraphVertex* m_leader{nullptr};
     std::vector<Edge<StronglyConnectedGraphVertex>*> m_edges{};
-    std::vector<Edge<StronglyConnectedGraphVertex>*> m_reverseEdges{};
 };
 
 class StronglyConnectedGraph :
@@ -47,7 +30,6 @@ class StronglyConnectedGraph :
 {
 public:
     StronglyConnectedGraph() = default;
-    ~StronglyConnectedGraph();
 
     std::size_t nvertices() const override { return m_vertices.size(); }
     std::size_t nedges() const override { return m_edges.size(); }
@@ -56,31 +38,46 @@ public:
 
     void addVertex(vertexid_t id) override
     {
-        auto v = new StronglyConnectedGraphVertex{id};
+        auto v = this->createVertex(id);
         m_vertices.push_back(v);
     }
     edgeid_t addEdge(edgeid_t id, StronglyConnectedGraphVertex* u,
                  StronglyConnectedGraphVertex* v, int /*value*/) override;
 
-    std::unordered_map<vertexid_t, unsigned int> kosaraju();
+    /**
+     * Strongly connected components (SCC) with Tarjan's algorithm, in Pearce's one array form
+     * and with an explicit stack. Returns the component id of every vertex, the ids are dense
+     * and in the order the components are completed, a reverse topological order.
+     */
+    std::vector<unsigned int> tarjan() const;
+    static std::vector<unsigned int> tarjan(const CsrGraph& graph);
+
+    /**
+     * Parallel SCC for large graphs: vertices with no incoming or no outgoing edge left are
+     * trimmed as their own components, the component of a high degree pivot is taken out with
+     * parallel forward and backward searches, and the rest is split by coloring: the largest
+     * vertex id reaching a vertex spreads forward, and the vertices of a color reaching its root
+     * backward are the component of the root. Gives the same components as tarjan(), the ids
+     * are dense but in no particular order.
+     */
+    static std::vector<unsigned int> findComponents(const CsrGraph& graph, ThreadPool& pool);
+
+    // graph of the components, an edge for every pair of components with an edge between them
+    static CsrGraph condense(const CsrGraph& graph, const std::vector<unsigned int>& components);
+
+    // vertices in an order where every edge goes forward, throws naming a vertex on a cycle if
+    // the graph has one
+    static std::vector<vertexid_t> topologicalOrder(const CsrGraph& dag);
+
+    // number of vertices in every component of the tarjan() ids
+    static std::vector<unsigned int> componentSizes(const std::vector<unsigned int>& components);
 
 private:
     void reserveVertices(std::size_t nvertices) override { m_vertices.reserve(nvertices); }
-    void reserveEdges(std::size_t nedges) override
-    {
-        m_edges.reserve(nedges);
-        m_reverseEdges.reserve(nedges);
-    }
-
-    void dfsLoopReverse();
-    void dfsReverse(StronglyConnectedGraphVertex* v);
-    void dfsLoop();
-    void dfs(StronglyConnectedGraphVertex* v, StronglyConnectedGraphVertex* leader);
+    void reserveEdges(std::size_t nedges) override { m_edges.reserve(nedges); }
 
     std::vector<StronglyConnectedGraphVertex*> m_vertices{};
-    std::vector<StronglyConnectedGraphVertex*> m_verticesByFinishTime{};
     std::vector<Edge<StronglyConnectedGraphVertex>*> m_edges{};
-    std::vector<Edge<StronglyConnectedGraphVertex>*> m_reverseEdges{};
 };
 
 } // namespace psa
@@ -0,0 +1,83 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_THREADPOOL_H
+#define PSA_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace psa {
+
+/**
+ * ThreadPool keeps a fixed set of worker threads for data parallel loops. The calling thread
+ * takes part in the work, so a pool of size 1 has no worker thread and runs everything inline.
+ * One loop runs at a time, a loop started from a task of the same pool runs inline on the
+ * calling thread. Tasks must not wait on another pool that waits on this one.
+ */
+class ThreadPool
+{
+public:
+    static const std::size_t kChunkGrain = 1024;
+
+public:
+    ThreadPool(std::size_t nthreads = defaultThreadCount());
+    ThreadPool(const ThreadPool& rhs) = delete;
+    ~ThreadPool();
+
+    ThreadPool& operator=(const ThreadPool& rhs) = delete;
+
+    static std::size_t defaultThreadCount();
+
+    std::size_t size() const { return m_workers.size() + 1; }
+
+    /**
+     * Calls func(i) for every i in [0, n), indices are handed out dynamically to the threads.
+     * Returns when all calls are done; the first exception thrown by func is rethrown here.
+     * Called from inside a task of this pool, the loop runs serially on the calling thread.
+     */
+    void parallelFor(std::size_t n, const std::function<void(std::size_t)>& func);
+
+    /**
+     * Splits [0, n) into about equal chunks, one per thread or fewer so that every chunk has at
+     * least grain indices (a single chunk when n is less than that), and calls
+     * func(chunk, first, last) for each of them. Nested in a task it runs serially, as
+     * parallelFor does.
+     * @return the number of chunks, chunk is in [0, that) and can index per chunk state.
+     */
+    std::size_t parallelForChunks(
+            std::size_t n,
+            const std::function<void(std::size_t, std::size_t, std::size_t)>& func,
+            std::size_t grain = kChunkGrain);
+
+private:
+    void work();
+    void runTasks();
+
+    std::vector<std::thread> m_workers{};
+
+    std::mutex m_mutex{};
+    std::condition_variable m_start{};
+    std::condition_variable m_done{};
+    std::mutex m_runMutex{}; // one parallelFor at a time, never taken again by a task
+
+    const std::function<void(std::size_t)>* m_func{nullptr};
+    std::size_t m_ntasks{0};
+    std::atomic<std::size_t> m_nextTask{0};
+    std::size_t m_generation{0};
+    std::size_t m_nbusy{0};
+    bool m_stop{false};
+    std::exception_ptr m_exception{};
+};
+
+} // namespace psa
+
+#endif // PSA_THREADPOOL_H
@@ -0,0 +1,110 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#ifndef PSA_UNIONFIND_H
+#define PSA_UNIONFIND_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "GraphTypes.h"
+
+namespace psa {
+
+class CsrGraph;
+
+/**
+ * UnionFind keeps disjoint sets of the elements [0, n) in two flat arrays, the parent of every
+ * element and the size of every root's set. find() halves the path as it goes, every element
+ * on it skips to its grandparent, so no extra memory is needed; unite() hangs the smaller set
+ * under the larger one.
+ */
+class UnionFind
+{
+public:
+    explicit UnionFind(std::size_t nelements = 0) { this->reset(nelements); }
+
+    // sets of all the vertices connected by the graph edges
+    static UnionFind connect(const CsrGraph& graph);
+
+    // every element back to a set of its own
+    void reset(std::size_t nelements);
+
+    std::size_t nelements() const { return m_parent.size(); }
+    std::size_t nsets() const { return m_nsets; }
+
+    vertexid_t find(vertexid_t v)
+    {
+        while (m_parent[v] != v) {
+            m_parent[v] = m_parent[m_parent[v]];
+            v = m_parent[v];
+        }
+        return v;
+    }
+
+    // find() without the path halving, for threads to share while no one unites
+    vertexid_t root(vertexid_t v) const
+    {
+        while (m_parent[v] != v)
+            v = m_parent[v];
+        return v;
+    }
+
+    // false if u and v are in the same set already
+    bool unite(vertexid_t u, vertexid_t v);
+
+    bool isSame(vertexid_t u, vertexid_t v) { return this->find(u) == this->find(v); }
+    std::uint32_t size(vertexid_t v) { return m_size[this->find(v)]; }
+
+    // dense set number of every element, the sets numbered in the order of their first element
+    std::vector<unsigned int> labels();
+
+private:
+    std::vector<std::uint32_t> m_parent{};
+    std::vector<std::uint32_t> m_size{};
+    std::size_t m_nsets{0};
+};
+
+/**
+ * ConcurrentUnionFind is the lock free variant for threads uniting and finding at the same
+ * time. A root is linked under the other one with a compare and swap on its parent, always the
+ * higher index under the lower, so a cycle can never form; find() halves the path with a
+ * compare and swap too, a lost race only means the path stays a little longer.
+ */
+class ConcurrentUnionFind
+{
+public:
+    explicit ConcurrentUnionFind(std::size_t nelements);
+
+    std::size_t nelements() const { return m_nelements; }
+
+    vertexid_t find(vertexid_t v)
+    {
+        for (;;) {
+            std::uint32_t parent = m_parent[v].load(std::memory_order_relaxed);
+            if (parent == v)
+                return v;
+            std::uint32_t grandparent = m_parent[parent].load(std::memory_order_relaxed);
+            if (parent != grandparent)
+                m_parent[v].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            v = grandparent;
+        }
+    }
+
+    // false if u and v are in the same set already
+    bool unite(vertexid_t u, vertexid_t v);
+
+    bool isSame(vertexid_t u, vertexid_t v);
+
+private:
+    std::size_t m_nelements;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> m_parent;
+};
+
+} // namespace psa
+
+#endif // PSA_UNIONFIND_H
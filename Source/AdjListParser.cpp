@@ -0,0 +1,198 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "AdjListParser.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ThreadPool.h"
+
+#ifdef UNIT_TEST
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+void AdjListParser::parseHeader()
+{
+    // type: "directed" or "undirected"
+    const char* lineEnd = std::find(m_pos, m_last, '\n');
+    const char* wordEnd = lineEnd;
+    while (wordEnd > m_pos && isBlank(*(wordEnd - 1)))
+        --wordEnd;
+
+    std::size_t len = wordEnd - m_pos;
+    if (len == 8 && std::strncmp(m_pos, "directed", len) == 0)
+        m_type = GraphType::Directed;
+    else if (len == 10 && std::strncmp(m_pos, "undirected", len) == 0)
+        m_type = GraphType::Undirected;
+    else
+        this->throwBadFormat("directed or undirected");
+
+    m_pos = lineEnd < m_last ? lineEnd + 1 : lineEnd;
+
+    // number of vertices followed by optional number of edges
+    const char* expected = "number of nodes followed by optional number of edges";
+    m_nvertices = static_cast<std::size_t>(this->parseUnsigned(expected));
+    if (!this->isTokenEnd())
+        this->throwBadFormat(expected);
+
+    this->skipBlanks();
+    if (!this->isLineEnd()) {
+        m_nedges = static_cast<std::size_t>(this->parseUnsigned(expected));
+        m_hasEdgeCount = true;
+    }
+
+    m_pos = std::find(m_pos, m_last, '\n');
+    if (m_pos < m_last)
+        ++m_pos;
+}
+
+std::vector<std::vector<CsrEdge>> AdjListParser::parseEdges(ThreadPool& pool)
+{
+    std::vector<const char*> bounds = splitLines(m_pos, m_last, pool.size());
+    std::vector<std::vector<CsrEdge>> chunks(bounds.size() - 1);
+
+    pool.parallelFor(chunks.size(), [this, &bounds, &chunks](std::size_t i) {
+        AdjListParser parser{bounds[i], bounds[i + 1]};
+        parser.m_first = m_first; // so errors report the whole line
+        parser.setVertexCount(m_nvertices);
+
+        // the header edge count spread by chunk size, capped at the shortest edge text "v,w\t"
+        // so a bogus count can't reserve more than the chunk could hold
+        auto& edges = chunks[i];
+        if (m_hasEdgeCount && m_last > m_pos) {
+            const std::size_t chunkBytes = bounds[i + 1] - bounds[i];
+            const double share = static_cast<double>(chunkBytes) / (m_last - m_pos);
+            edges.reserve(std::min<std::size_t>(static_cast<std::size_t>(m_nedges * share) + 1,
+                                                chunkBytes / 4));
+        }
+        parser.parseEdges([&edges](vertexid_t u, vertexid_t v, int value) {
+            edges.push_back(CsrEdge{u, v, value});
+        });
+    });
+
+    m_pos = m_last;
+
+    return chunks;
+}
+
+std::vector<const char*> AdjListParser::splitLines(const char* first, const char* last,
+                                                   std::size_t nchunks)
+{
+    std::vector<const char*> bounds{first};
+    if (nchunks == 0)
+        nchunks = 1;
+
+    std::size_t chunkSize = (last - first) / nchunks + 1;
+    while (bounds.back() < last) {
+        const char* p = bounds.back() + std::min<std::size_t>(chunkSize, last - bounds.back());
+        p = std::find(p, last, '\n'); // move to the end of the line
+        if (p < last)
+            ++p;
+        bounds.push_back(p);
+    }
+
+    if (bounds.size() == 1) // empty buffer
+        bounds.push_back(last);
+
+    return bounds;
+}
+
+void AdjListParser::throwBadFormat(const char* expected) const
+{
+    // report the whole line that has the offending token
+    const char* lineStart = m_pos;
+    while (lineStart > m_first && lineStart[-1] != '\n')
+        --lineStart;
+    const char* lineEnd = std::find(m_pos, m_last, '\n');
+
+    throw AlgoException{fmt::format(AlgoException::GraphBadFormat, expected,
+                                    std::string(lineStart, lineEnd))};
+}
+
+#ifdef UNIT_TEST
+
+TEST(AdjListParserTest, Parse)
+{
+    const std::string text{"undirected\r\n4\t3\n\n0\t1,7   2,-3\n\n2 3\r\n"};
+
+    AdjListParser parser{text.data(), text.data() + text.size()};
+    parser.parseHeader();
+    EXPECT_EQ(GraphType::Undirected, parser.type());
+    EXPECT_EQ(4u, parser.nvertices());
+    EXPECT_TRUE(parser.hasEdgeCount());
+    EXPECT_EQ(3u, parser.nedges());
+
+    std::vector<std::tuple<vertexid_t, vertexid_t, int>> edges;
+    parser.parseEdges([&edges](vertexid_t u, vertexid_t v, int value) {
+        edges.emplace_back(u, v, value);
+    });
+
+    std::vector<std::tuple<vertexid_t, vertexid_t, int>> expected{
+        std::make_tuple(0, 1, 7), std::make_tuple(0, 2, -3), std::make_tuple(2, 3, 0)};
+    EXPECT_EQ(expected, edges);
+}
+
+TEST(AdjListParserTest, BadFormat)
+{
+    const std::vector<std::string> texts{
+        "bidirected\n4\n",
+        "directed\nfour\n",
+        "directed\n4\n0 1;2\n",
+        "directed\n4\n0 4\n",
+        "directed\n4\n0 1,3000000000\n",
+        "directed\n4\n0 1,-3000000000\n",
+    };
+
+    for (auto& text : texts) {
+        bool passed = false;
+        try {
+            AdjListParser parser{text.data(), text.data() + text.size()};
+            parser.parseHeader();
+            parser.parseEdges([](vertexid_t, vertexid_t, int) {});
+        } catch (const AlgoException& /*e*/) {
+            passed = true;
+        }
+        EXPECT_TRUE(passed) << "Parsing '" << text << "' should throw an exception!";
+    }
+}
+
+TEST(AdjListParserTest, ParallelParse)
+{
+    std::string text{"directed\n100\n"};
+    for (int u = 0; u < 100; ++u) {
+        text += std::to_string(u);
+        for (int v = 0; v < u % 7; ++v)
+            text += "\t" + std::to_string((u * 31 + v) % 100) + "," + std::to_string(u - v);
+        text += "\n";
+    }
+
+    AdjListParser parser{text.data(), text.data() + text.size()};
+    parser.parseHeader();
+    AdjListParser parallelParser = parser;
+
+    std::vector<std::tuple<vertexid_t, vertexid_t, int>> expected;
+    parser.parseEdges([&expected](vertexid_t u, vertexid_t v, int value) {
+        expected.emplace_back(u, v, value);
+    });
+
+    ThreadPool pool{4};
+    std::vector<std::tuple<vertexid_t, vertexid_t, int>> actual;
+    for (auto& chunk : parallelParser.parseEdges(pool)) {
+        for (auto& e : chunk)
+            actual.emplace_back(e.u, e.v, e.value);
+    }
+
+    EXPECT_EQ(expected, actual);
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
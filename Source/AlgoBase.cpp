@@ -5,6 +5,7 @@
 
 #include "AlgoBase.h"
 
+#include <cstring>
 #include <utility>
 
 #ifdef UNIT_TEST
@@ -29,11 +30,13 @@ bool isequal(float lhs, float rhs)
     if (std::isnan(lhs) || std::isnan(rhs))
         return false;
 
-    int lhsInt = *reinterpret_cast<int*>(&lhs);
+    int lhsInt;
+    std::memcpy(&lhsInt, &lhs, sizeof(lhsInt));
     if (lhsInt < 0)
         lhsInt = kSignBitMaskInt - lhsInt;
 
-    int rhsInt = *reinterpret_cast<int*>(&rhs);
+    int rhsInt;
+    std::memcpy(&rhsInt, &rhs, sizeof(rhsInt));
     if (rhsInt < 0)
         rhsInt = kSignBitMaskInt - rhsInt;
 
@@ -50,11 +53,13 @@ bool isequal(double lhs, double rhs)
     if (std::isnan(lhs) || std::isnan(rhs))
         return false;
 
-    long long lhsLongLong = *reinterpret_cast<long long*>(&lhs);
+    long long lhsLongLong;
+    std::memcpy(&lhsLongLong, &lhs, sizeof(lhsLongLong));
     if (lhsLongLong < 0)
         lhsLongLong = kSignBitMaskLongLong - lhsLongLong;
 
-    long long rhsLongLong = *reinterpret_cast<long long*>(&rhs);
+    long long rhsLongLong;
+    std::memcpy(&rhsLongLong, &rhs, sizeof(rhsLongLong));
     if (rhsLongLong < 0)
         rhsLongLong = kSignBitMaskLongLong - rhsLongLong;
 
@@ -71,11 +76,13 @@ bool isequal(double lhs, double rhs)
     if (std::isnan(lhs) || std::isnan(rhs))
         return false;
 
-    long lhsLong = *reinterpret_cast<long*>(&lhs);
+    long lhsLong;
+    std::memcpy(&lhsLong, &lhs, sizeof(lhsLong));
     if (lhsLong < 0)
         lhsLong = kSignBitMaskLong - lhsLong;
 
-    long rhsLong = *reinterpret_cast<long*>(&rhs);
+    long rhsLong;
+    std::memcpy(&rhsLong, &rhs, sizeof(rhsLong));
     if (rhsLong < 0)
         rhsLong = kSignBitMaskLong - rhsLong;
 
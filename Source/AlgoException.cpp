@@ -9,10 +9,28 @@ namespace psa {
 
 const char* AlgoException::InvalidIndex = "The index for {} is not within the range [{}, {}].";
 const char* AlgoException::FileOpenRead = "Could not open the '{}' for reading.";
+const char* AlgoException::FileOpenWrite = "Could not open the '{}' for writing.";
+const char* AlgoException::FileMap = "Could not memory map the '{}': {}.";
+const char* AlgoException::FileWrite = "Could not write to the '{}': {}.";
+const char* AlgoException::FileRead = "Could not read from the '{}': {}.";
 
 const char* AlgoException::StackUnderflow = "No more elements in the Stack!";
 
+const char* AlgoException::HeapEmpty = "There is no more elements in the heap.";
+const char* AlgoException::HeapIdNotFound = "The id {} is not in the heap.";
+const char* AlgoException::HeapKeyNotMonotone =
+        "The key {} is smaller than the last key {} taken out of the monotone queue.";
+const char* AlgoException::HeapKeyIncreased = "The new key of id {} is larger than its key.";
+
 const char* AlgoException::GraphBadFormat = "Bad graph format, expected: {}, actual: {}.";
+const char* AlgoException::GraphBadCsrFile = "The '{}' is not a valid CSR graph file: {}.";
+const char* AlgoException::GraphBadIndexFile = "The '{}' is not a valid {} index file: {}.";
+const char* AlgoException::GraphIndexMismatch =
+        "The {} index is built for {} vertices, the graph has {}.";
+const char* AlgoException::GraphIndexStale =
+        "The {} index is built for another graph of as many vertices, the {} differ.";
+const char* AlgoException::GraphNotAcyclic = "The graph has a cycle through vertex {}.";
+const char* AlgoException::GraphClusterCount = "Cannot make {} clusters of {} vertices.";
 
 const char* AlgoException::MatrixZeroDimension =
         "Trying to create a matrix of zero dimension is allowed.";
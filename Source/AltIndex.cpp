@@ -0,0 +1,390 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "AltIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "CsrGraph.h"
+
+#ifdef UNIT_TEST
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+namespace {
+
+const char kAltMagic[8] = {'P', 'S', 'A', 'A', 'L', 'T', '\0', '\0'};
+
+struct AltFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t nvertices;
+    std::uint64_t nlandmarks;
+    std::uint64_t nedges;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(AltFileHeader) == 48, "ALT file header must be packed to 48 bytes");
+static_assert(sizeof(unsigned int) == sizeof(std::uint32_t), "ALT file stores distances as uint32");
+
+std::size_t altFileSize(std::size_t nvertices, std::size_t nlandmarks)
+{
+    return sizeof(AltFileHeader) + nlandmarks * sizeof(vertexid_t)
+            + 2 * nvertices * nlandmarks * sizeof(unsigned int);
+}
+
+} // anonymous
+
+/**
+ * Picks the landmarks one by one, each the vertex farthest from the landmarks so far (a vertex
+ * none of them reaches counts as farthest), starting with the vertex farthest from vertex 0.
+ * Every landmark costs a forward search on graph and a backward search on reverse.
+ */
+AltIndex AltIndex::build(const CsrGraph& graph, const CsrGraph& reverse, std::size_t nlandmarks)
+{
+    const std::size_t nvertices = graph.nvertices();
+    if (reverse.nvertices() != nvertices)
+        throw AlgoException{fmt::format(AlgoException::GraphIndexMismatch, "reverse graph",
+                                        reverse.nvertices(), nvertices)};
+
+    AltIndex index;
+    index.m_nvertices = nvertices;
+    index.m_nlandmarks = nvertices == 0 ? 0 : std::min(nlandmarks, nvertices);
+    index.m_nedges = graph.nedges();
+    index.m_checksum = graph.checksum();
+    index.m_fromStorage.resize(nvertices * index.m_nlandmarks);
+    index.m_toStorage.resize(nvertices * index.m_nlandmarks);
+
+    SearchContext context;
+    std::vector<unsigned int> nearest(nvertices, 0); // distance from the closest landmark
+
+    if (index.m_nlandmarks > 0) {
+        DijkstraGraph::findShortestPath(graph, 0, context);
+        for (vertexid_t v = 0; v < nvertices; ++v)
+            nearest[v] = context.distance(v);
+    }
+
+    for (std::size_t i = 0; i < index.m_nlandmarks; ++i) {
+        vertexid_t landmark = static_cast<vertexid_t>(
+                std::max_element(nearest.begin(), nearest.end()) - nearest.begin());
+        index.m_landmarkStorage.push_back(landmark);
+
+        DijkstraGraph::findShortestPath(graph, landmark, context);
+        for (vertexid_t v = 0; v < nvertices; ++v) {
+            unsigned int distance = context.distance(v);
+            index.m_fromStorage[v * index.m_nlandmarks + i] = distance;
+            nearest[v] = i == 0 ? distance : std::min(nearest[v], distance);
+        }
+        nearest[landmark] = 0;
+
+        DijkstraGraph::findShortestPath(reverse, landmark, context);
+        for (vertexid_t v = 0; v < nvertices; ++v)
+            index.m_toStorage[v * index.m_nlandmarks + i] = context.distance(v);
+    }
+
+    index.m_landmarks = index.m_landmarkStorage.data();
+    index.m_from = index.m_fromStorage.data();
+    index.m_to = index.m_toStorage.data();
+
+    return index;
+}
+
+/**
+ * Maps the ALT file and uses the tables in place. The counts are checked against the file size
+ * before they are multiplied, and every landmark must be a vertex.
+ */
+AltIndex AltIndex::load(const std::string& filePath)
+{
+    MappedFile file{filePath};
+
+    AltFileHeader header;
+    if (file.size() < sizeof(header))
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "ALT",
+                                        "too small")};
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, kAltMagic, sizeof(kAltMagic)) != 0)
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "ALT",
+                                        "bad magic")};
+    if (header.version != kVersion)
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "ALT",
+                                        fmt::format("unsupported version {}", header.version))};
+    if (header.nvertices > std::numeric_limits<vertexid_t>::max())
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "ALT",
+                                        "too many vertices")};
+
+    // the landmarks and both tables must fit in the file, then their sizes cannot overflow
+    const std::size_t rowSize = 2 * sizeof(unsigned int);
+    if (header.nlandmarks > file.size() / sizeof(vertexid_t)
+            || (header.nlandmarks != 0
+                && header.nvertices > file.size() / rowSize / header.nlandmarks)
+            || file.size() != altFileSize(header.nvertices, header.nlandmarks))
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "ALT",
+                                        "size mismatch")};
+
+    AltIndex index;
+    index.m_nvertices = header.nvertices;
+    index.m_nlandmarks = header.nlandmarks;
+    index.m_nedges = header.nedges;
+    index.m_checksum = header.checksum;
+
+    const char* p = file.data() + sizeof(header);
+    index.m_landmarks = reinterpret_cast<const vertexid_t*>(p);
+    p += index.m_nlandmarks * sizeof(vertexid_t);
+    index.m_from = reinterpret_cast<const unsigned int*>(p);
+    p += index.m_nvertices * index.m_nlandmarks * sizeof(unsigned int);
+    index.m_to = reinterpret_cast<const unsigned int*>(p);
+
+    for (std::size_t i = 0; i < index.m_nlandmarks; ++i) {
+        if (index.m_landmarks[i] >= index.m_nvertices)
+            throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "ALT",
+                                            fmt::format("bad landmark {}", i))};
+    }
+
+    index.m_file = std::move(file);
+
+    return index;
+}
+
+void AltIndex::save(const std::string& filePath) const
+{
+    MappedFile file{filePath, altFileSize(m_nvertices, m_nlandmarks)};
+
+    AltFileHeader header;
+    std::memcpy(header.magic, kAltMagic, sizeof(kAltMagic));
+    header.version = kVersion;
+    header.reserved = 0;
+    header.nvertices = m_nvertices;
+    header.nlandmarks = m_nlandmarks;
+    header.nedges = m_nedges;
+    header.checksum = m_checksum;
+
+    const std::size_t ntable = m_nvertices * m_nlandmarks * sizeof(unsigned int);
+
+    char* p = file.data();
+    std::memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    std::memcpy(p, m_landmarks, m_nlandmarks * sizeof(vertexid_t));
+    p += m_nlandmarks * sizeof(vertexid_t);
+    std::memcpy(p, m_from, ntable);
+    p += ntable;
+    std::memcpy(p, m_to, ntable);
+
+    file.commit();
+}
+
+unsigned int AltIndex::lowerBound(vertexid_t v, vertexid_t t) const
+{
+    const unsigned int infinity = SearchContext::kInfinity;
+
+    const unsigned int* fromV = m_from + v * m_nlandmarks;
+    const unsigned int* fromT = m_from + t * m_nlandmarks;
+    const unsigned int* toV = m_to + v * m_nlandmarks;
+    const unsigned int* toT = m_to + t * m_nlandmarks;
+
+    unsigned int bound = 0;
+    for (std::size_t i = 0; i < m_nlandmarks; ++i) {
+        // L reaches v but not t, or t reaches L but v doesn't: no path from v to t
+        if ((fromV[i] != infinity && fromT[i] == infinity)
+                || (toT[i] != infinity && toV[i] == infinity))
+            return infinity;
+
+        if (fromT[i] != infinity && fromT[i] > fromV[i])
+            bound = std::max(bound, fromT[i] - fromV[i]);
+        if (toV[i] != infinity && toV[i] > toT[i])
+            bound = std::max(bound, toV[i] - toT[i]);
+    }
+
+    return bound;
+}
+
+ShortestPath AltIndex::shortestPath(const CsrGraph& graph,
+                                    vertexid_t sourceVertexId, vertexid_t targetVertexId) const
+{
+    SearchContext context;
+    return this->shortestPath(graph, sourceVertexId, targetVertexId, context);
+}
+
+/**
+ * A* from the source, the heap key of a vertex is its distance plus the landmark lower bound
+ * to the target. The bound is consistent, so a settled vertex is final and the search stops
+ * as soon as the target is settled.
+ */
+ShortestPath AltIndex::shortestPath(const CsrGraph& graph,
+                                    vertexid_t sourceVertexId, vertexid_t targetVertexId,
+                                    SearchContext& context) const
+{
+    if (graph.nvertices() != m_nvertices)
+        throw AlgoException{fmt::format(AlgoException::GraphIndexMismatch, "ALT",
+                                        m_nvertices, graph.nvertices())};
+    if (graph.nedges() != m_nedges || graph.checksum() != m_checksum)
+        throw AlgoException{fmt::format(AlgoException::GraphIndexStale, "ALT",
+                                        graph.nedges() != m_nedges ? "edge counts"
+                                                                  : "edges or weights")};
+    if (sourceVertexId >= m_nvertices)
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        sourceVertexId)};
+    if (targetVertexId >= m_nvertices)
+        throw AlgoException{fmt::format("The given target vertex id, {} is not in the graph!",
+                                        targetVertexId)};
+
+    ShortestPath result;
+
+    context.reset(m_nvertices);
+    if (this->lowerBound(sourceVertexId, targetVertexId) == SearchContext::kInfinity)
+        return result;
+
+    IndexedMinHeap<unsigned int>& verticesToProcess = context.heap();
+    context.reach(sourceVertexId, 0, SearchContext::kNoVertex);
+    verticesToProcess.push(sourceVertexId, this->lowerBound(sourceVertexId, targetVertexId));
+
+    while (!verticesToProcess.isEmpty()) {
+        vertexid_t v = verticesToProcess.pop().id;
+        context.settle(v);
+        ++result.nsettled;
+
+        if (v == targetVertexId) {
+            result.distance = context.distance(v);
+            result.path = context.path(v);
+            break;
+        }
+
+        unsigned int distanceToV = context.distance(v);
+        for (edgeid_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+            vertexid_t w = graph.target(e);
+            unsigned int distance = distanceToV + static_cast<unsigned int>(graph.weight(e));
+            if (context.isSettled(w) || distance >= context.distance(w))
+                continue;
+
+            unsigned int bound = this->lowerBound(w, targetVertexId);
+            if (bound == SearchContext::kInfinity)
+                continue;
+
+            context.reach(w, distance, v);
+            verticesToProcess.pushOrDecrease(w, distance + bound);
+        }
+    }
+
+    return result;
+}
+
+#ifdef UNIT_TEST
+
+TEST(AltIndexTest, Query)
+{
+    const std::size_t nvertices = 1500;
+    CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 3 * nvertices, 4, {1, 1000});
+
+    AltIndex index = AltIndex::build(graph, graph.reverse(), 8);
+    EXPECT_EQ(8u, index.nlandmarks());
+
+    const std::string filename{"AltIndexTest.alt"};
+    index.save(filename);
+    AltIndex loaded = AltIndex::load(filename);
+    EXPECT_TRUE(loaded.isMapped());
+
+    SearchContext context;
+    std::size_t nsettledAlt = 0;
+    std::size_t nsettledDijkstra = 0;
+    for (vertexid_t source : {3u, 800u, 1499u}) {
+        std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, source);
+        for (vertexid_t target = 0; target < nvertices; target += 29) {
+            EXPECT_LE(index.lowerBound(source, target), expected[target]);
+
+            ShortestPath actual = index.shortestPath(graph, source, target, context);
+            ASSERT_EQ(expected[target], actual.distance) << source << " -> " << target;
+            EXPECT_EQ(actual.distance, loaded.shortestPath(graph, source, target).distance);
+            if (actual.distance != SearchContext::kInfinity) {
+                EXPECT_EQ(source, actual.path.front());
+                EXPECT_EQ(target, actual.path.back());
+            }
+
+            nsettledAlt += actual.nsettled;
+            nsettledDijkstra += std::count_if(expected.begin(), expected.end(),
+                    [&expected, target](unsigned int d) { return d < expected[target]; });
+        }
+    }
+    EXPECT_LT(nsettledAlt, nsettledDijkstra);
+
+    // saving a mapped index onto its own file reads the old file while writing the new one
+    loaded.save(filename);
+    loaded = AltIndex::load(filename);
+    for (vertexid_t target = 0; target < nvertices; target += 97)
+        EXPECT_EQ(index.lowerBound(3, target), loaded.lowerBound(3, target));
+
+    loaded = AltIndex{};
+    std::remove(filename.c_str());
+
+    bool passed = false;
+    try {
+        AltIndex::load("DijkstraAdjList.txt");
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "Loading a file that is not an ALT index should throw!";
+}
+
+TEST(AltIndexTest, LoadCorrupt)
+{
+    const std::string filename{"AltIndexTest.alt"};
+    CsrGraph graph = CsrGraph::fromAdjList("DijkstraAdjList.txt");
+    AltIndex index = AltIndex::build(graph, graph.reverse(), 3);
+    const std::size_t landmarksAt = 48;
+
+    // overwrite the bytes at position with value, every case starting from a good file
+    auto expectCorrupt = [&](std::size_t position, std::uint64_t value, std::size_t size) {
+        index.save(filename);
+        {
+            std::fstream stream{filename, std::ios::in | std::ios::out | std::ios::binary};
+            stream.seekp(position);
+            stream.write(reinterpret_cast<const char*>(&value), size);
+        }
+        EXPECT_THROW(AltIndex::load(filename), AlgoException) << position << " " << value;
+    };
+
+    expectCorrupt(16, std::uint64_t{1} << 32, 8);             // more vertices than ids
+    expectCorrupt(16, std::uint64_t{1} << 31, 8);             // nvertices over the size
+    expectCorrupt(24, std::uint64_t{1} << 62, 8);             // nlandmarks over the size
+    expectCorrupt(24, std::uint64_t{1} << 61, 8);             // 2^61 * 8 bytes wraps to 0
+    expectCorrupt(landmarksAt + sizeof(vertexid_t), 10, 4);   // landmark outside the graph
+
+    index.save(filename);
+    EXPECT_EQ(index.landmark(1), AltIndex::load(filename).landmark(1));
+    std::remove(filename.c_str());
+}
+
+TEST(AltIndexTest, StaleIndex)
+{
+    // same vertices and edges, one edge got longer: the bounds may now overestimate
+    std::vector<CsrEdge> edges = randomCsrEdges(200, 800, 11, {1, 100});
+    CsrGraph graph{GraphType::Directed, 200, edges};
+    AltIndex index = AltIndex::build(graph, graph.reverse(), 4);
+
+    edges[17].value += 1000;
+    CsrGraph reweighted{GraphType::Directed, 200, edges};
+    EXPECT_THROW(index.shortestPath(reweighted, 0, 1), AlgoException);
+    edges.pop_back();
+    EXPECT_THROW(index.shortestPath(CsrGraph{GraphType::Directed, 200, edges}, 0, 1),
+                 AlgoException);
+
+    CsrGraph same{GraphType::Directed, 200, randomCsrEdges(200, 800, 11, {1, 100})};
+    EXPECT_EQ(index.shortestPath(graph, 0, 1).distance, index.shortestPath(same, 0, 1).distance);
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -0,0 +1,237 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "BoruvkaMinSpanningGraph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+#include "UnionFind.h"
+
+#ifdef UNIT_TEST
+#include <gtest/gtest.h>
+
+#include "KruskalMinSpanningGraph.h"
+#endif
+
+namespace psa {
+
+namespace {
+
+const edgeid_t kNoEdge = std::numeric_limits<edgeid_t>::max();
+
+/**
+ * The edges of a graph and, for a directed one, of its reverse under one id space, the
+ * reverse edges numbered after the forward ones.
+ */
+class UndirectedEdges
+{
+public:
+    UndirectedEdges(const CsrGraph& graph, const CsrGraph* reverse)
+        : m_graph{graph}
+        , m_reverse{reverse}
+    {}
+
+    template<typename Func>
+    void forEach(vertexid_t u, Func func) const
+    {
+        for (edgeid_t e = m_graph.edgeBegin(u); e < m_graph.edgeEnd(u); ++e)
+            func(e, m_graph.target(e));
+        if (m_reverse) {
+            for (edgeid_t e = m_reverse->edgeBegin(u); e < m_reverse->edgeEnd(u); ++e)
+                func(m_graph.nedges() + e, m_reverse->target(e));
+        }
+    }
+
+    vertexid_t target(edgeid_t e) const
+    {
+        return e < m_graph.nedges() ? m_graph.target(e) : m_reverse->target(e - m_graph.nedges());
+    }
+
+    int weight(edgeid_t e) const
+    {
+        return e < m_graph.nedges() ? m_graph.weight(e) : m_reverse->weight(e - m_graph.nedges());
+    }
+
+    // (weight, id) order, every edge is lighter than kNoEdge
+    bool isLighter(edgeid_t a, edgeid_t b) const
+    {
+        if (b == kNoEdge)
+            return true;
+        int wa = this->weight(a);
+        int wb = this->weight(b);
+        return wa < wb || (wa == wb && a < b);
+    }
+
+    CsrEdge edge(edgeid_t e) const
+    {
+        const CsrGraph& graph = e < m_graph.nedges() ? m_graph : *m_reverse;
+        edgeid_t local = e < m_graph.nedges() ? e : e - m_graph.nedges();
+        const edgeid_t* offsets = graph.offsets();
+        auto next = std::upper_bound(offsets, offsets + graph.nvertices() + 1, local);
+        auto source = static_cast<vertexid_t>(next - offsets - 1);
+        return CsrEdge{source, graph.target(local), graph.weight(local)};
+    }
+
+private:
+    const CsrGraph& m_graph;
+    const CsrGraph* m_reverse;
+};
+
+} // anonymous
+
+long BoruvkaMinSpanningGraph::findMst(const CsrGraph& graph, ThreadPool& pool)
+{
+    std::vector<CsrEdge> edges;
+    return BoruvkaMinSpanningGraph::findMst(graph, pool, edges);
+}
+
+long BoruvkaMinSpanningGraph::findMst(const CsrGraph& graph, ThreadPool& pool,
+                                      std::vector<CsrEdge>& edges)
+{
+    edges.clear();
+    const std::size_t nvertices = graph.nvertices();
+
+    CsrGraph reverse;
+    if (graph.type() == GraphType::Directed)
+        reverse = graph.reverse();
+    UndirectedEdges graphEdges{graph, graph.type() == GraphType::Directed ? &reverse : nullptr};
+
+    ConcurrentUnionFind sets{nvertices};
+    std::vector<vertexid_t> components(nvertices);
+    std::unique_ptr<std::atomic<edgeid_t>[]> lightest{new std::atomic<edgeid_t>[nvertices]};
+    pool.parallelForChunks(nvertices, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t v = first; v < last; ++v) {
+            components[v] = static_cast<vertexid_t>(v);
+            lightest[v].store(kNoEdge, std::memory_order_relaxed);
+        }
+    });
+
+    // the vertices with an edge out of their component, as of the last round
+    std::vector<vertexid_t> active(nvertices);
+    for (vertexid_t v = 0; v < nvertices; ++v)
+        active[v] = v;
+
+    std::vector<std::vector<vertexid_t>> buffers(pool.size());
+    std::vector<std::vector<edgeid_t>> treeEdges(pool.size());
+
+    for (;;) {
+        for (auto& buffer : buffers)
+            buffer.clear();
+
+        // the lightest edge out of every component
+        pool.parallelForChunks(active.size(), [&](std::size_t task, std::size_t first,
+                                                  std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const vertexid_t u = active[i];
+                const vertexid_t component = components[u];
+                edgeid_t best = kNoEdge;
+                graphEdges.forEach(u, [&](edgeid_t e, vertexid_t v) {
+                    if (components[v] != component && graphEdges.isLighter(e, best))
+                        best = e;
+                });
+                if (best == kNoEdge)
+                    continue;
+
+                buffers[task].push_back(u);
+                std::atomic<edgeid_t>& slot = lightest[component];
+                edgeid_t current = slot.load(std::memory_order_relaxed);
+                while (graphEdges.isLighter(best, current)
+                        && !slot.compare_exchange_weak(current, best, std::memory_order_relaxed)) {
+                }
+            }
+        });
+
+        active.clear();
+        for (auto& buffer : buffers)
+            active.insert(active.end(), buffer.begin(), buffer.end());
+        if (active.empty())
+            break;
+
+        // the first active vertex of a component to take its edge contracts it
+        pool.parallelForChunks(active.size(), [&](std::size_t task, std::size_t first,
+                                                  std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const vertexid_t component = components[active[i]];
+                edgeid_t e = lightest[component].exchange(kNoEdge, std::memory_order_relaxed);
+                if (e != kNoEdge && sets.unite(component, graphEdges.target(e)))
+                    treeEdges[task].push_back(e);
+            }
+        });
+
+        pool.parallelForChunks(nvertices, [&](std::size_t, std::size_t first, std::size_t last) {
+            for (std::size_t v = first; v < last; ++v)
+                components[v] = sets.find(static_cast<vertexid_t>(v));
+        });
+    }
+
+    long cost = 0;
+    for (auto& taskEdges : treeEdges) {
+        for (edgeid_t e : taskEdges) {
+            edges.push_back(graphEdges.edge(e));
+            cost += edges.back().value;
+        }
+    }
+    return cost;
+}
+
+#ifdef UNIT_TEST
+
+namespace {
+
+// the edges are a spanning forest of graph: no cycle and as many as the graph needs
+void expectSpanningForest(const CsrGraph& graph, const std::vector<CsrEdge>& edges, long cost)
+{
+    UnionFind forest{graph.nvertices()};
+    long sum = 0;
+    for (auto& edge : edges) {
+        EXPECT_TRUE(forest.unite(edge.u, edge.v)) << edge.u << " - " << edge.v;
+        sum += edge.value;
+    }
+    EXPECT_EQ(cost, sum);
+
+    UnionFind components = UnionFind::connect(graph);
+    EXPECT_EQ(components.nsets(), forest.nsets());
+}
+
+} // anonymous
+
+TEST(BoruvkaMinSpanningGraphTest, Mst)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    for (std::size_t nthreads : {1, 4}) {
+        ThreadPool pool{nthreads};
+        std::vector<CsrEdge> edges;
+        EXPECT_EQ(39, BoruvkaMinSpanningGraph::findMst(graph, pool, edges));
+        EXPECT_EQ(graph.nvertices() - 1, edges.size());
+        expectSpanningForest(graph, edges, 39);
+    }
+}
+
+TEST(BoruvkaMinSpanningGraphTest, RandomGraphs)
+{
+    // few distinct costs for many ties, sparse enough to leave a few components apart
+    const std::size_t nvertices = 50000;
+    for (GraphType type : {GraphType::Undirected, GraphType::Directed}) {
+        CsrGraph graph = randomCsrGraph(type, nvertices, 3 * nvertices, 23, {-50, 50});
+        long expected = KruskalMinSpanningGraph::findMst(graph);
+
+        for (std::size_t nthreads : {1, 4}) {
+            ThreadPool pool{nthreads};
+            std::vector<CsrEdge> tree;
+            long cost = BoruvkaMinSpanningGraph::findMst(graph, pool, tree);
+            EXPECT_EQ(expected, cost);
+            expectSpanningForest(graph, tree, cost);
+        }
+    }
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
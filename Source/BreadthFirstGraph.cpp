@@ -5,13 +5,23 @@
 
 #include "BreadthFirstGraph.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <queue>
 #include <sstream>
 
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
 #ifdef UNIT_TEST
 #include <fstream>
+#include <random>
 
-#include <fmt/format.h>
 #include <gtest/gtest.h>
 #endif
 
@@ -29,15 +39,6 @@ std::string BreadthFirstGraphVertex::toString() const
     return stream.str();
 }
 
-BreadthFirstGraph::~BreadthFirstGraph()
-{
-    for (auto it = m_edges.begin(); it != m_edges.end(); ++it)
-        delete *it;
-
-    for (auto it = m_vertices.begin(); it != m_vertices.end(); ++it)
-        delete *it;
-}
-
 void BreadthFirstGraph::traverse(vertexid_t startVertexId)
 {
     BreadthFirstGraphVertex* u = this->vertex(startVertexId);
@@ -91,6 +92,470 @@ unsigned int BreadthFirstGraph::distance(vertexid_t startVertexId, vertexid_t en
     return end->distance();
 }
 
+/**
+ * Same as distance(startVertexId, endVertexId) but the search state goes to the context, the
+ * vertices are left untouched.
+ * @return number of hops from start to end vertex, -1 if end is not reachable.
+ */
+int BreadthFirstGraph::distance(vertexid_t startVertexId, vertexid_t endVertexId,
+                                SearchContext& context) const
+{
+    if (startVertexId >= m_vertices.size())
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        startVertexId)};
+    if (endVertexId >= m_vertices.size())
+        throw AlgoException{fmt::format("The given target vertex id, {} is not in the graph!",
+                                        endVertexId)};
+
+    context.reset(m_vertices.size());
+    context.reach(startVertexId, 0, SearchContext::kNoVertex);
+
+    std::vector<vertexid_t>& queue = context.queue();
+    queue.push_back(startVertexId);
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        vertexid_t u = queue[head];
+        if (u == endVertexId)
+            break;
+
+        for (auto e : m_vertices[u]->edges()) {
+            vertexid_t v = e->v()->id();
+            if (!context.isReached(v)) {
+                context.reach(v, context.distance(u) + 1, u);
+                queue.push_back(v);
+            }
+        }
+    }
+
+    return context.isReached(endVertexId) ? static_cast<int>(context.distance(endVertexId)) : -1;
+}
+
+/**
+ * @brief BreadthFirstGraph::traverse does breadth first search on CSR topology.
+ * @return number of hops to every vertex from the start vertex, -1 if not reachable.
+ */
+std::vector<int> BreadthFirstGraph::traverse(const CsrGraph& graph, vertexid_t startVertexId)
+{
+    SearchContext context;
+    BreadthFirstGraph::traverse(graph, startVertexId, context);
+
+    std::vector<int> distances(graph.nvertices(), -1);
+    for (vertexid_t v = 0; v < graph.nvertices(); ++v) {
+        if (context.isReached(v))
+            distances[v] = static_cast<int>(context.distance(v));
+    }
+    return distances;
+}
+
+/**
+ * Breadth first search from the start vertex with the state held in the context. The vertices
+ * are queued in the context queue, which ends up holding them in the order they were reached.
+ */
+void BreadthFirstGraph::traverse(const CsrGraph& graph, vertexid_t startVertexId,
+                                 SearchContext& context)
+{
+    if (startVertexId >= graph.nvertices())
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        startVertexId)};
+
+    context.reset(graph.nvertices());
+    context.reach(startVertexId, 0, SearchContext::kNoVertex);
+
+    std::vector<vertexid_t>& queue = context.queue();
+    queue.push_back(startVertexId);
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        vertexid_t u = queue[head];
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            if (!context.isReached(v)) {
+                context.reach(v, context.distance(u) + 1, u);
+                queue.push_back(v);
+            }
+        }
+    }
+}
+
+int BreadthFirstGraph::distance(const CsrGraph& graph,
+                                vertexid_t startVertexId, vertexid_t endVertexId)
+{
+    SearchContext context;
+    return BreadthFirstGraph::distance(graph, startVertexId, endVertexId, context);
+}
+
+/**
+ * @return number of hops from start to end vertex, -1 if end is not reachable.
+ */
+int BreadthFirstGraph::distance(const CsrGraph& graph,
+                                vertexid_t startVertexId, vertexid_t endVertexId,
+                                SearchContext& context)
+{
+    if (startVertexId >= graph.nvertices())
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        startVertexId)};
+    if (endVertexId >= graph.nvertices())
+        throw AlgoException{fmt::format("The given target vertex id, {} is not in the graph!",
+                                        endVertexId)};
+
+    context.reset(graph.nvertices());
+    context.reach(startVertexId, 0, SearchContext::kNoVertex);
+
+    std::vector<vertexid_t>& queue = context.queue();
+    queue.push_back(startVertexId);
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        vertexid_t u = queue[head];
+        if (u == endVertexId)
+            break;
+
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            if (!context.isReached(v)) {
+                context.reach(v, context.distance(u) + 1, u);
+                queue.push_back(v);
+            }
+        }
+    }
+
+    return context.isReached(endVertexId) ? static_cast<int>(context.distance(endVertexId)) : -1;
+}
+
+namespace {
+
+// one bit per vertex
+class VertexBitmap
+{
+public:
+    explicit VertexBitmap(std::size_t nvertices) : m_words((nvertices + 63) / 64, 0) {}
+
+    std::size_t nwords() const { return m_words.size(); }
+    std::uint64_t word(std::size_t i) const { return m_words[i]; }
+
+    bool test(vertexid_t v) const { return (m_words[v / 64] >> (v % 64)) & 1; }
+    void set(vertexid_t v) { m_words[v / 64] |= std::uint64_t{1} << (v % 64); }
+    void clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+    void swap(VertexBitmap& rhs) { m_words.swap(rhs.m_words); }
+
+private:
+    std::vector<std::uint64_t> m_words;
+};
+
+// frontier vertices a thread takes at a time
+const std::size_t kFrontierChunk = 1024;
+
+// bit-parallel search state kept across the batches of 64 sources, one word per vertex
+struct MultiSourceState
+{
+    explicit MultiSourceState(std::size_t nvertices)
+        : seen(nvertices, 0), frontier(nvertices, 0), next(nvertices, 0)
+    {
+    }
+
+    std::vector<std::uint64_t> seen;
+    std::vector<std::uint64_t> frontier;
+    std::vector<std::uint64_t> next;
+    std::vector<vertexid_t> active{};  // vertices with frontier bits
+    std::vector<vertexid_t> touched{}; // vertices with next bits
+};
+
+/**
+ * Runs the searches from sources[first, first + 64) together and calls visit(v, bits, level)
+ * for every vertex reached at the level, bit i of bits standing for sources[first + i]. A level
+ * ORs the bits of every frontier vertex into its neighbors, then keeps the ones not seen yet.
+ * Only the frontier vertices and the neighbors they touched are gone over, so a level costs its
+ * edges rather than the whole graph. frontier and next are all zero on entry and on return.
+ */
+template<typename Visit>
+void searchMultiSource(const CsrGraph& graph, const std::vector<vertexid_t>& sources,
+                       std::size_t first, MultiSourceState& state, Visit visit)
+{
+    std::vector<std::uint64_t>& seen = state.seen;
+    std::vector<std::uint64_t>& frontier = state.frontier;
+    std::vector<std::uint64_t>& next = state.next;
+    std::vector<vertexid_t>& active = state.active;
+    std::vector<vertexid_t>& touched = state.touched;
+    std::fill(seen.begin(), seen.end(), 0);
+
+    active.clear();
+    const std::size_t last = std::min(sources.size(), first + 64);
+    for (std::size_t i = first; i < last; ++i) {
+        if (frontier[sources[i]] == 0)
+            active.push_back(sources[i]);
+        seen[sources[i]] |= std::uint64_t{1} << (i - first);
+        frontier[sources[i]] |= std::uint64_t{1} << (i - first);
+    }
+
+    for (int level = 0; !active.empty(); ++level) {
+        touched.clear();
+        for (vertexid_t u : active) {
+            std::uint64_t bits = frontier[u];
+            frontier[u] = 0;
+            visit(u, bits, level);
+            for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                vertexid_t v = graph.target(e);
+                if (next[v] == 0)
+                    touched.push_back(v);
+                next[v] |= bits;
+            }
+        }
+
+        active.clear();
+        for (vertexid_t v : touched) {
+            std::uint64_t bits = next[v] & ~seen[v];
+            next[v] = 0;
+            if (bits == 0)
+                continue;
+            seen[v] |= bits;
+            frontier[v] = bits;
+            active.push_back(v);
+        }
+    }
+}
+
+// calls searchMultiSource for every batch of 64 sources, visit(v, bits, level, first)
+template<typename Visit>
+void searchBatches(const CsrGraph& graph, const std::vector<vertexid_t>& sources, Visit visit)
+{
+    for (vertexid_t source : sources) {
+        if (source >= graph.nvertices())
+            throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                            source)};
+    }
+
+    MultiSourceState state{graph.nvertices()};
+    for (std::size_t first = 0; first < sources.size(); first += 64) {
+        searchMultiSource(graph, sources, first, state,
+                          [&visit, first](vertexid_t v, std::uint64_t bits, int level) {
+            visit(v, bits, level, first);
+        });
+    }
+}
+
+// Beamer's switch points: go bottom up once the frontier has more than 1/kAlpha of the edges
+// left to check, back top down once it has fewer than 1/kBeta of the vertices
+const std::size_t kAlpha = 14;
+const std::size_t kBeta = 24;
+
+} // anonymous
+
+std::vector<std::vector<int>> BreadthFirstGraph::traverse(
+        const CsrGraph& graph, const std::vector<vertexid_t>& startVertexIds)
+{
+    std::vector<std::vector<int>> distances(startVertexIds.size(),
+                                            std::vector<int>(graph.nvertices(), -1));
+    searchBatches(graph, startVertexIds, [&distances](vertexid_t v, std::uint64_t bits,
+                                                      int level, std::size_t first) {
+        for (; bits != 0; bits &= bits - 1)
+            distances[first + __builtin_ctzll(bits)][v] = level;
+    });
+    return distances;
+}
+
+std::vector<std::vector<std::size_t>> BreadthFirstGraph::countLevels(
+        const CsrGraph& graph, const std::vector<vertexid_t>& startVertexIds)
+{
+    std::vector<std::vector<std::size_t>> counts(startVertexIds.size());
+    searchBatches(graph, startVertexIds, [&counts](vertexid_t /*v*/, std::uint64_t bits,
+                                                   int level, std::size_t first) {
+        for (; bits != 0; bits &= bits - 1) {
+            std::vector<std::size_t>& levels = counts[first + __builtin_ctzll(bits)];
+            if (levels.size() <= static_cast<std::size_t>(level))
+                levels.resize(level + 1, 0);
+            ++levels[level];
+        }
+    });
+    return counts;
+}
+
+/**
+ * Every level is a parallel pass over the frontier; the thread whose fetch_or sets the visited
+ * bit of a vertex is the only one writing its distance and parent. The next frontier is put
+ * together from the thread buffers at their prefix sum offsets, in parallel as well.
+ */
+BreadthFirstTree BreadthFirstGraph::traverse(const CsrGraph& graph, vertexid_t startVertexId,
+                                             ThreadPool& pool)
+{
+    const std::size_t nvertices = graph.nvertices();
+    if (startVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        startVertexId)};
+
+    BreadthFirstTree tree;
+    tree.distances.assign(nvertices, -1);
+    tree.parents.assign(nvertices, SearchContext::kNoVertex);
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> visited{
+            new std::atomic<std::uint64_t>[(nvertices + 63) / 64]};
+    for (std::size_t i = 0; i < (nvertices + 63) / 64; ++i)
+        visited[i].store(0, std::memory_order_relaxed);
+
+    auto claim = [&visited](vertexid_t v) {
+        std::uint64_t bit = std::uint64_t{1} << (v % 64);
+        if (visited[v / 64].load(std::memory_order_relaxed) & bit)
+            return false;
+        return (visited[v / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    };
+
+    claim(startVertexId);
+    tree.distances[startVertexId] = 0;
+
+    std::vector<vertexid_t> frontier{startVertexId};
+    std::vector<vertexid_t> next;
+    std::vector<std::vector<vertexid_t>> buffers(pool.size());
+    std::vector<std::size_t> offsets(pool.size() + 1);
+
+    for (int level = 1; !frontier.empty(); ++level) {
+        const std::size_t nchunks = (frontier.size() + kFrontierChunk - 1) / kFrontierChunk;
+        const std::size_t ntasks = std::min(buffers.size(), nchunks);
+        std::atomic<std::size_t> nextChunk{0};
+
+        pool.parallelFor(ntasks, [&](std::size_t task) {
+            std::vector<vertexid_t>& buffer = buffers[task];
+            buffer.clear();
+            for (std::size_t chunk = nextChunk++; chunk < nchunks; chunk = nextChunk++) {
+                std::size_t last = std::min(frontier.size(), (chunk + 1) * kFrontierChunk);
+                for (std::size_t i = chunk * kFrontierChunk; i < last; ++i) {
+                    vertexid_t u = frontier[i];
+                    for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                        vertexid_t v = graph.target(e);
+                        if (claim(v)) {
+                            tree.distances[v] = level;
+                            tree.parents[v] = u;
+                            buffer.push_back(v);
+                        }
+                    }
+                }
+            }
+        });
+
+        for (std::size_t task = 0; task < ntasks; ++task)
+            offsets[task + 1] = offsets[task] + buffers[task].size();
+        next.resize(offsets[ntasks]);
+        pool.parallelFor(ntasks, [&](std::size_t task) {
+            std::copy(buffers[task].begin(), buffers[task].end(), next.begin() + offsets[task]);
+        });
+        frontier.swap(next);
+    }
+
+    return tree;
+}
+
+BreadthFirstTree BreadthFirstGraph::traverseDirectionOptimizing(const CsrGraph& graph,
+                                                                vertexid_t startVertexId)
+{
+    if (graph.type() == GraphType::Undirected)
+        return BreadthFirstGraph::traverseDirectionOptimizing(graph, graph, startVertexId);
+
+    CsrGraph reverse = graph.reverse();
+    return BreadthFirstGraph::traverseDirectionOptimizing(graph, reverse, startVertexId);
+}
+
+/**
+ * The distances are the same as the plain search gives, a parent may be another vertex of the
+ * level before. Top down levels keep the frontier as a vertex list, bottom up ones as a bitmap;
+ * the frontier changes form only when the direction changes.
+ */
+BreadthFirstTree BreadthFirstGraph::traverseDirectionOptimizing(const CsrGraph& graph,
+                                                                const CsrGraph& reverse,
+                                                                vertexid_t startVertexId)
+{
+    const std::size_t nvertices = graph.nvertices();
+    if (reverse.nvertices() != nvertices)
+        throw AlgoException{fmt::format(AlgoException::GraphIndexMismatch, "reverse graph",
+                                        reverse.nvertices(), nvertices)};
+    if (startVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        startVertexId)};
+
+    BreadthFirstTree tree;
+    tree.distances.assign(nvertices, -1);
+    tree.parents.assign(nvertices, SearchContext::kNoVertex);
+
+    VertexBitmap visited{nvertices};
+    VertexBitmap frontierBits{nvertices};
+    VertexBitmap nextBits{nvertices};
+    std::vector<vertexid_t> frontier{startVertexId};
+    std::vector<vertexid_t> next;
+
+    tree.distances[startVertexId] = 0;
+    visited.set(startVertexId);
+
+    std::size_t frontierEdges = graph.degree(startVertexId);        // to check top down
+    std::size_t unvisitedEdges = reverse.nedges() - reverse.degree(startVertexId); // bottom up
+    std::size_t frontierSize = 1;
+    bool bottomUp = false;
+
+    for (int level = 1; frontierSize > 0; ++level) {
+        if (!bottomUp && frontierEdges > unvisitedEdges / kAlpha) {
+            frontierBits.clear();
+            for (vertexid_t u : frontier)
+                frontierBits.set(u);
+            bottomUp = true;
+        } else if (bottomUp && frontierSize < nvertices / kBeta) {
+            frontier.clear();
+            for (std::size_t i = 0; i < frontierBits.nwords(); ++i) {
+                for (std::uint64_t word = frontierBits.word(i); word != 0; word &= word - 1)
+                    frontier.push_back(static_cast<vertexid_t>(i * 64 + __builtin_ctzll(word)));
+            }
+            bottomUp = false;
+        }
+
+        std::size_t nextSize = 0;
+        std::size_t nextEdges = 0;
+        auto discover = [&](vertexid_t v, vertexid_t parent) {
+            tree.distances[v] = level;
+            tree.parents[v] = parent;
+            ++nextSize;
+            nextEdges += graph.degree(v);
+            unvisitedEdges -= reverse.degree(v);
+        };
+
+        if (bottomUp) {
+            ++tree.nbottomUpLevels;
+            nextBits.clear();
+            for (std::size_t i = 0; i < visited.nwords(); ++i) {
+                std::uint64_t unvisited = ~visited.word(i);
+                for (; unvisited != 0; unvisited &= unvisited - 1) {
+                    vertexid_t v = static_cast<vertexid_t>(i * 64 + __builtin_ctzll(unvisited));
+                    if (v >= nvertices)
+                        break;
+                    for (edgeid_t e = reverse.edgeBegin(v); e < reverse.edgeEnd(v); ++e) {
+                        vertexid_t u = reverse.target(e);
+                        if (frontierBits.test(u)) {
+                            discover(v, u);
+                            nextBits.set(v);
+                            break;
+                        }
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < nextBits.nwords(); ++i) {
+                for (std::uint64_t word = nextBits.word(i); word != 0; word &= word - 1)
+                    visited.set(static_cast<vertexid_t>(i * 64 + __builtin_ctzll(word)));
+            }
+            frontierBits.swap(nextBits);
+        } else {
+            next.clear();
+            for (vertexid_t u : frontier) {
+                for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                    vertexid_t v = graph.target(e);
+                    if (!visited.test(v)) {
+                        visited.set(v);
+                        discover(v, u);
+                        next.push_back(v);
+                    }
+                }
+            }
+            frontier.swap(next);
+        }
+
+        frontierSize = nextSize;
+        frontierEdges = nextEdges;
+    }
+
+    return tree;
+}
+
 #ifdef UNIT_TEST
 
 TEST(BreadthFirstGraphTest, BreadthFirstSearch)
@@ -106,5 +571,151 @@ TEST(BreadthFirstGraphTest, BreadthFirstSearch)
     EXPECT_EQ(distanceExpected, distanceActual);
 }
 
+TEST(BreadthFirstGraphTest, CsrBreadthFirstSearch)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("BreadthFirstAdjList.txt");
+    EXPECT_EQ(2, BreadthFirstGraph::distance(graph, 0, 2));
+
+    std::vector<int> expected{0, 1, 2, 2, 1};
+    EXPECT_EQ(expected, BreadthFirstGraph::traverse(graph, 0));
+
+    const vertexid_t outside = static_cast<vertexid_t>(graph.nvertices());
+    EXPECT_THROW(BreadthFirstGraph::traverse(graph, outside), AlgoException);
+    EXPECT_THROW(BreadthFirstGraph::distance(graph, outside, 0), AlgoException);
+    EXPECT_THROW(BreadthFirstGraph::distance(graph, 0, outside), AlgoException);
+}
+
+TEST(BreadthFirstGraphTest, ContextReuse)
+{
+    BreadthFirstGraph graph;
+    graph.readAdjList("BreadthFirstAdjList.txt");
+    CsrGraph csr = CsrGraph::fromAdjList("BreadthFirstAdjList.txt");
+
+    SearchContext context;
+    for (int round = 0; round < 3; ++round) {
+        EXPECT_EQ(2, graph.distance(0, 2, context));
+        EXPECT_EQ(2, BreadthFirstGraph::distance(csr, 0, 2, context));
+        EXPECT_EQ(0, BreadthFirstGraph::distance(csr, 3, 3, context));
+    }
+    EXPECT_FALSE(graph.vertex(2)->isExplored()) << "Graph must not change!";
+
+    const vertexid_t outside = static_cast<vertexid_t>(csr.nvertices());
+    EXPECT_THROW(graph.distance(outside, 0, context), AlgoException);
+    EXPECT_THROW(graph.distance(0, outside, context), AlgoException);
+
+    BreadthFirstGraph::traverse(csr, 0, context);
+    EXPECT_EQ(csr.nvertices(), context.queue().size());
+    EXPECT_EQ(0u, context.queue().front());
+}
+
+TEST(BreadthFirstGraphTest, MultiSource)
+{
+    const std::size_t nvertices = 3000;
+    CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 2 * nvertices, 17);
+
+    // two batches, the second partial, with a repeated source
+    std::mt19937 random{17};
+    std::uniform_int_distribution<vertexid_t> vertices{0, nvertices - 1};
+    std::vector<vertexid_t> sources;
+    for (int i = 0; i < 100; ++i)
+        sources.push_back(vertices(random));
+    sources.push_back(sources.front());
+
+    std::vector<std::vector<int>> distances = BreadthFirstGraph::traverse(graph, sources);
+    std::vector<std::vector<std::size_t>> counts = BreadthFirstGraph::countLevels(graph, sources);
+    ASSERT_EQ(sources.size(), distances.size());
+    ASSERT_EQ(sources.size(), counts.size());
+
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        std::vector<int> expected = BreadthFirstGraph::traverse(graph, sources[i]);
+        EXPECT_EQ(expected, distances[i]) << "source " << sources[i];
+
+        std::vector<std::size_t> levels;
+        for (int distance : expected) {
+            if (distance < 0)
+                continue;
+            if (levels.size() <= static_cast<std::size_t>(distance))
+                levels.resize(distance + 1, 0);
+            ++levels[distance];
+        }
+        EXPECT_EQ(levels, counts[i]);
+    }
+
+    // a long path, every level has a single vertex per source
+    const std::size_t length = 20000;
+    std::vector<CsrEdge> edges;
+    for (vertexid_t u = 0; u + 1 < length; ++u)
+        edges.push_back(CsrEdge{u, u + 1, 0});
+    CsrGraph path{GraphType::Directed, length, edges};
+    distances = BreadthFirstGraph::traverse(path, {0, 5, 19999});
+    EXPECT_EQ(19999, distances[0][19999]);
+    EXPECT_EQ(-1, distances[1][4]);
+    EXPECT_EQ(19994, distances[1][19999]);
+    EXPECT_EQ(0, distances[2][19999]);
+}
+
+TEST(BreadthFirstGraphTest, ParallelTraverse)
+{
+    const std::size_t nvertices = 20000;
+    CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 3 * nvertices, 16);
+
+    for (std::size_t nthreads : {1, 4}) {
+        ThreadPool pool{nthreads};
+        BreadthFirstTree tree = BreadthFirstGraph::traverse(graph, 17, pool);
+        ASSERT_EQ(BreadthFirstGraph::traverse(graph, 17), tree.distances);
+
+        EXPECT_EQ(SearchContext::kNoVertex, tree.parents[17]);
+        for (vertexid_t v = 0; v < nvertices; ++v) {
+            vertexid_t parent = tree.parents[v];
+            if (parent == SearchContext::kNoVertex)
+                continue;
+            EXPECT_EQ(tree.distances[parent] + 1, tree.distances[v]);
+        }
+    }
+}
+
+TEST(BreadthFirstGraphTest, DirectionOptimizing)
+{
+    // a small world graph: a ring with random shortcuts, the middle levels go bottom up
+    std::mt19937 random{15};
+    const std::size_t nvertices = 5000;
+    std::uniform_int_distribution<vertexid_t> vertices{0, nvertices - 1};
+
+    for (GraphType type : {GraphType::Undirected, GraphType::Directed}) {
+        std::vector<CsrEdge> edges;
+        for (vertexid_t v = 0; v < nvertices; ++v) {
+            edges.push_back(CsrEdge{v, static_cast<vertexid_t>((v + 1) % nvertices), 0});
+            for (int i = 0; i < 4; ++i)
+                edges.push_back(CsrEdge{v, vertices(random), 0});
+        }
+        CsrGraph graph{type, nvertices, edges};
+
+        for (vertexid_t start : {0u, 4321u}) {
+            BreadthFirstTree tree = BreadthFirstGraph::traverseDirectionOptimizing(graph, start);
+            EXPECT_EQ(BreadthFirstGraph::traverse(graph, start), tree.distances);
+            int depth = *std::max_element(tree.distances.begin(), tree.distances.end());
+            EXPECT_GT(tree.nbottomUpLevels, 0u) << "The middle levels should go bottom up!";
+            EXPECT_LT(tree.nbottomUpLevels, static_cast<std::size_t>(depth))
+                << "The first level should go top down!";
+
+            EXPECT_EQ(SearchContext::kNoVertex, tree.parents[start]);
+            for (vertexid_t v = 0; v < nvertices; ++v) {
+                vertexid_t parent = tree.parents[v];
+                if (v == start || parent == SearchContext::kNoVertex)
+                    continue;
+                EXPECT_EQ(tree.distances[parent] + 1, tree.distances[v]);
+                bool isEdge = false;
+                for (edgeid_t e = graph.edgeBegin(parent); e < graph.edgeEnd(parent); ++e)
+                    isEdge = isEdge || graph.target(e) == v;
+                EXPECT_TRUE(isEdge) << parent << " -> " << v;
+            }
+        }
+    }
+
+    CsrGraph small = CsrGraph::fromAdjList("BreadthFirstAdjList.txt");
+    std::vector<int> expected{0, 1, 2, 2, 1};
+    EXPECT_EQ(expected, BreadthFirstGraph::traverseDirectionOptimizing(small, 0).distances);
+}
+
 #endif
 }
@@ -0,0 +1,51 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "BucketQueue.h"
+
+#ifdef UNIT_TEST
+#include <random>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+#ifdef UNIT_TEST
+
+TEST(BucketQueueTest, MonotoneGrow)
+{
+    std::mt19937 random{11};
+
+    BucketQueue<unsigned int> queue;
+    queue.push(0, 0);
+
+    // spread grows past the initial ring half way through
+    unsigned int last = 0;
+    std::size_t npopped = 0;
+    while (!queue.isEmpty()) {
+        auto entry = queue.pop();
+        EXPECT_LE(last, entry.key);
+        last = entry.key;
+
+        unsigned int maxLength = npopped < 1000 ? 10 : 1000;
+        std::uniform_int_distribution<unsigned int> lengths{0, maxLength};
+        if (++npopped < 3000) {
+            for (int i = 0; i < 3; ++i)
+                queue.push(static_cast<vertexid_t>(npopped), entry.key + lengths(random));
+        }
+    }
+    EXPECT_EQ(0u, queue.size());
+
+    queue.clear();
+    queue.push(4, 5);
+    queue.push(2, 3);
+    EXPECT_EQ(2u, queue.pop().id);
+    EXPECT_EQ(4u, queue.pop().id);
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -0,0 +1,879 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "ContractionHierarchy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "CsrGraph.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#ifdef UNIT_TEST
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+namespace {
+
+const char kChMagic[8] = {'P', 'S', 'A', 'C', 'H', '\0', '\0', '\0'};
+
+struct ChFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t nvertices;
+    std::uint64_t nup;
+    std::uint64_t ndown;
+    std::uint64_t nedges;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(ChFileHeader) == 56, "CH file header must be packed to 56 bytes");
+
+std::size_t arcsFileSize(std::size_t nvertices, std::size_t narcs)
+{
+    return (nvertices + 1) * sizeof(edgeid_t)
+            + narcs * (2 * sizeof(vertexid_t) + sizeof(unsigned int));
+}
+
+std::size_t chFileSize(std::size_t nvertices, std::size_t nup, std::size_t ndown)
+{
+    return sizeof(ChFileHeader) + nvertices * sizeof(vertexid_t)
+            + arcsFileSize(nvertices, nup) + arcsFileSize(nvertices, ndown);
+}
+
+struct Arc
+{
+    vertexid_t target;
+    unsigned int weight;
+    vertexid_t middle;
+};
+
+struct Shortcut
+{
+    vertexid_t u;
+    vertexid_t w;
+    unsigned int weight;
+    vertexid_t middle;
+};
+
+const vertexid_t kNoVertex = SearchContext::kNoVertex;
+
+// chunks of a parallel pass per pool thread
+const std::size_t kChunksPerThread = 4;
+
+/**
+ * Contractor keeps the remaining graph as in and out arc lists per vertex while the vertices
+ * get contracted. Each round contracts an independent set of vertices, those with smaller
+ * priority than all the vertices within two hops: the shortcuts and the priorities are computed in
+ * parallel on the read only graph, the graph is changed between the parallel passes.
+ */
+class Contractor
+{
+public:
+    Contractor(const CsrGraph& graph, ThreadPool& pool);
+
+    void run();
+
+    std::vector<vertexid_t> m_rank;
+    std::vector<std::vector<Arc>> m_upArcs;
+    std::vector<std::vector<Arc>> m_downArcs;
+
+private:
+    enum State : std::uint8_t { kActive, kBatch, kContracted };
+
+    void addArc(vertexid_t u, vertexid_t w, unsigned int weight, vertexid_t middle);
+    void witnessSearch(vertexid_t u, vertexid_t v, unsigned int limit,
+                       SearchContext& context) const;
+    void findShortcuts(vertexid_t v, SearchContext& context,
+                       std::vector<Shortcut>& shortcuts) const;
+    int edgeDifference(vertexid_t v, SearchContext& context,
+                       std::vector<Shortcut>& shortcuts) const;
+    bool isLocalMinimum(vertexid_t v) const;
+
+    /**
+     * Calls func(task, first, last, context) on chunks of [0, n). There are a few chunks per
+     * thread for balance but only one context per thread, a running task takes a free one.
+     */
+    template<typename Func> void forChunks(std::size_t n, Func func);
+
+    ThreadPool& m_pool;
+    std::size_t m_nvertices;
+    std::vector<std::vector<Arc>> m_out;
+    std::vector<std::vector<Arc>> m_in;
+    std::vector<State> m_state;
+    std::vector<int> m_priority;
+    std::vector<int> m_contractedNeighbors;
+
+    std::vector<SearchContext> m_contexts;
+    std::unique_ptr<std::atomic<bool>[]> m_contextInUse;
+    std::vector<std::vector<Shortcut>> m_shortcuts;
+    std::vector<std::vector<vertexid_t>> m_selected;
+};
+
+Contractor::Contractor(const CsrGraph& graph, ThreadPool& pool)
+    : m_rank(graph.nvertices(), kNoVertex)
+    , m_upArcs(graph.nvertices())
+    , m_downArcs(graph.nvertices())
+    , m_pool{pool}
+    , m_nvertices{graph.nvertices()}
+    , m_out(graph.nvertices())
+    , m_in(graph.nvertices())
+    , m_state(graph.nvertices(), kActive)
+    , m_priority(graph.nvertices(), 0)
+    , m_contractedNeighbors(graph.nvertices(), 0)
+    , m_contexts(pool.size())
+    , m_contextInUse{new std::atomic<bool>[pool.size()]}
+    , m_shortcuts(kChunksPerThread * pool.size())
+    , m_selected(m_shortcuts.size())
+{
+    for (std::size_t i = 0; i < m_contexts.size(); ++i)
+        m_contextInUse[i].store(false, std::memory_order_relaxed);
+
+    for (vertexid_t u = 0; u < m_nvertices; ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e)
+            this->addArc(u, graph.target(e), static_cast<unsigned int>(graph.weight(e)), kNoVertex);
+    }
+}
+
+template<typename Func>
+void Contractor::forChunks(std::size_t n, Func func)
+{
+    const std::size_t ntasks = std::min(n / 64 + 1, m_shortcuts.size());
+    m_pool.parallelFor(ntasks, [this, n, ntasks, &func](std::size_t task) {
+        // no more tasks run at once than there are threads, so one is always free
+        std::size_t c = 0;
+        while (m_contextInUse[c].exchange(true, std::memory_order_acquire))
+            c = (c + 1) % m_contexts.size();
+
+        struct Release
+        {
+            std::atomic<bool>& inUse;
+            ~Release() { inUse.store(false, std::memory_order_release); }
+        } release{m_contextInUse[c]};
+
+        func(task, n * task / ntasks, n * (task + 1) / ntasks, m_contexts[c]);
+    });
+}
+
+// adds u -> w or lowers the weight of the one there, self loops are dropped
+void Contractor::addArc(vertexid_t u, vertexid_t w, unsigned int weight, vertexid_t middle)
+{
+    if (u == w)
+        return;
+
+    auto out = std::find_if(m_out[u].begin(), m_out[u].end(),
+                            [w](const Arc& arc) { return arc.target == w; });
+    if (out == m_out[u].end()) {
+        m_out[u].push_back(Arc{w, weight, middle});
+        m_in[w].push_back(Arc{u, weight, middle});
+        return;
+    }
+    if (weight >= out->weight)
+        return;
+
+    *out = Arc{w, weight, middle};
+    auto in = std::find_if(m_in[w].begin(), m_in[w].end(),
+                           [u](const Arc& arc) { return arc.target == u; });
+    *in = Arc{u, weight, middle};
+}
+
+// Dijkstra from u over the active vertices other than v, up to distance limit
+void Contractor::witnessSearch(vertexid_t u, vertexid_t v, unsigned int limit,
+                               SearchContext& context) const
+{
+    context.reset(m_nvertices);
+    context.reach(u, 0, kNoVertex);
+    context.heap().push(u, 0);
+
+    std::size_t nsettled = 0;
+    while (!context.heap().isEmpty() && context.heap().top().key <= limit
+            && nsettled++ < ContractionHierarchy::kWitnessSettleLimit) {
+        vertexid_t x = context.heap().pop().id;
+        context.settle(x);
+
+        for (auto& arc : m_out[x]) {
+            vertexid_t y = arc.target;
+            if (y == v || m_state[y] != kActive)
+                continue;
+            unsigned int distance = context.distance(x) + arc.weight;
+            if (distance <= limit && distance < context.distance(y)) {
+                context.reach(y, distance, x);
+                context.heap().pushOrDecrease(y, distance);
+            }
+        }
+    }
+}
+
+void Contractor::findShortcuts(vertexid_t v, SearchContext& context,
+                               std::vector<Shortcut>& shortcuts) const
+{
+    for (auto& in : m_in[v]) {
+        vertexid_t u = in.target;
+        if (m_state[u] != kActive)
+            continue;
+
+        unsigned int limit = 0;
+        bool hasTarget = false;
+        for (auto& out : m_out[v]) {
+            if (out.target != u && m_state[out.target] == kActive) {
+                limit = std::max(limit, in.weight + out.weight);
+                hasTarget = true;
+            }
+        }
+        if (!hasTarget)
+            continue;
+
+        this->witnessSearch(u, v, limit, context);
+
+        // a tentative distance is never below the true one, a witness is a real path
+        for (auto& out : m_out[v]) {
+            vertexid_t w = out.target;
+            if (w == u || m_state[w] != kActive)
+                continue;
+            if (context.distance(w) > in.weight + out.weight)
+                shortcuts.push_back(Shortcut{u, w, in.weight + out.weight, v});
+        }
+    }
+}
+
+int Contractor::edgeDifference(vertexid_t v, SearchContext& context,
+                               std::vector<Shortcut>& shortcuts) const
+{
+    shortcuts.clear();
+    this->findShortcuts(v, context, shortcuts);
+
+    std::size_t nremoved = 0;
+    for (auto& arc : m_out[v])
+        nremoved += m_state[arc.target] == kActive;
+    for (auto& arc : m_in[v])
+        nremoved += m_state[arc.target] == kActive;
+
+    return static_cast<int>(shortcuts.size()) - static_cast<int>(nremoved)
+            + m_contractedNeighbors[v];
+}
+
+// v comes before every active vertex within two hops, so no two of the batch share a neighbor
+bool Contractor::isLocalMinimum(vertexid_t v) const
+{
+    auto key = [this](vertexid_t x) { return std::make_pair(m_priority[x], x); };
+    auto isBefore = [this, v, &key](const std::vector<Arc>& arcs) {
+        for (auto& arc : arcs) {
+            if (arc.target != v && m_state[arc.target] == kActive && key(arc.target) < key(v))
+                return false;
+        }
+        return true;
+    };
+
+    for (const std::vector<std::vector<Arc>>* lists : {&m_out, &m_in}) {
+        for (auto& arc : (*lists)[v]) {
+            if (m_state[arc.target] != kActive)
+                continue;
+            if (key(arc.target) < key(v) || !isBefore(m_out[arc.target])
+                    || !isBefore(m_in[arc.target]))
+                return false;
+        }
+    }
+    return true;
+}
+
+void Contractor::run()
+{
+    std::vector<vertexid_t> remaining(m_nvertices);
+    for (vertexid_t v = 0; v < m_nvertices; ++v)
+        remaining[v] = v;
+
+    this->forChunks(remaining.size(), [this, &remaining](std::size_t task, std::size_t first,
+                                                         std::size_t last, SearchContext& context) {
+        for (std::size_t i = first; i < last; ++i)
+            m_priority[remaining[i]] = this->edgeDifference(remaining[i], context,
+                                                            m_shortcuts[task]);
+    });
+
+    vertexid_t nextRank = 0;
+    std::vector<vertexid_t> batch;
+    std::vector<vertexid_t> neighbors;
+    std::vector<std::uint8_t> isNeighbor(m_nvertices, 0);
+
+    while (!remaining.empty()) {
+        // the vertex of the lowest priority is always picked, every round makes progress; fewer
+        // tasks run as the rounds go, so the lists of the others must not keep their old picks
+        for (auto& selected : m_selected)
+            selected.clear();
+        this->forChunks(remaining.size(), [this, &remaining](std::size_t task, std::size_t first,
+                                                             std::size_t last, SearchContext&) {
+            for (std::size_t i = first; i < last; ++i) {
+                if (this->isLocalMinimum(remaining[i]))
+                    m_selected[task].push_back(remaining[i]);
+            }
+        });
+
+        batch.clear();
+        for (auto& selected : m_selected)
+            batch.insert(batch.end(), selected.begin(), selected.end());
+        for (vertexid_t v : batch)
+            m_state[v] = kBatch;
+
+        // witness searches avoid the whole batch, it's going away together
+        for (auto& shortcuts : m_shortcuts)
+            shortcuts.clear();
+        this->forChunks(batch.size(), [this, &batch](std::size_t task, std::size_t first,
+                                                     std::size_t last, SearchContext& context) {
+            for (std::size_t i = first; i < last; ++i)
+                this->findShortcuts(batch[i], context, m_shortcuts[task]);
+        });
+
+        // the arcs left to active vertices go up the hierarchy
+        neighbors.clear();
+        for (vertexid_t v : batch) {
+            for (auto& arc : m_out[v]) {
+                if (m_state[arc.target] == kActive) {
+                    m_upArcs[v].push_back(arc);
+                    ++m_contractedNeighbors[arc.target];
+                    if (!isNeighbor[arc.target]) {
+                        isNeighbor[arc.target] = 1;
+                        neighbors.push_back(arc.target);
+                    }
+                }
+            }
+            for (auto& arc : m_in[v]) {
+                if (m_state[arc.target] == kActive) {
+                    m_downArcs[v].push_back(arc);
+                    ++m_contractedNeighbors[arc.target];
+                    if (!isNeighbor[arc.target]) {
+                        isNeighbor[arc.target] = 1;
+                        neighbors.push_back(arc.target);
+                    }
+                }
+            }
+
+            m_rank[v] = nextRank++;
+            std::vector<Arc>{}.swap(m_out[v]);
+            std::vector<Arc>{}.swap(m_in[v]);
+        }
+        for (vertexid_t v : batch)
+            m_state[v] = kContracted;
+
+        for (auto& shortcuts : m_shortcuts) {
+            for (auto& s : shortcuts)
+                this->addArc(s.u, s.w, s.weight, s.middle);
+        }
+
+        // drop the arcs to the contracted vertices, then reprice the neighbors
+        this->forChunks(neighbors.size(), [this, &neighbors](std::size_t /*task*/,
+                                                             std::size_t first, std::size_t last,
+                                                             SearchContext&) {
+            auto contracted = [this](const Arc& arc) { return m_state[arc.target] == kContracted; };
+            for (std::size_t i = first; i < last; ++i) {
+                std::vector<Arc>& out = m_out[neighbors[i]];
+                out.erase(std::remove_if(out.begin(), out.end(), contracted), out.end());
+                std::vector<Arc>& in = m_in[neighbors[i]];
+                in.erase(std::remove_if(in.begin(), in.end(), contracted), in.end());
+            }
+        });
+        this->forChunks(neighbors.size(), [this, &neighbors](std::size_t task, std::size_t first,
+                                                             std::size_t last,
+                                                             SearchContext& context) {
+            for (std::size_t i = first; i < last; ++i)
+                m_priority[neighbors[i]] = this->edgeDifference(neighbors[i], context,
+                                                                m_shortcuts[task]);
+        });
+        for (vertexid_t x : neighbors)
+            isNeighbor[x] = 0;
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                       [this](vertexid_t v) { return m_state[v] == kContracted; }),
+                        remaining.end());
+    }
+}
+
+} // anonymous
+
+ContractionHierarchy ContractionHierarchy::build(const CsrGraph& graph, ThreadPool& pool)
+{
+    Contractor contractor{graph, pool};
+    contractor.run();
+
+    ContractionHierarchy hierarchy;
+    hierarchy.m_nedges = graph.nedges();
+    hierarchy.m_checksum = graph.checksum();
+    hierarchy.m_rank = std::move(contractor.m_rank);
+
+    auto toCsr = [](const std::vector<std::vector<Arc>>& lists, Arcs& arcs) {
+        arcs.offsets.assign(1, 0);
+        for (auto& list : lists) {
+            for (auto& arc : list) {
+                arcs.targets.push_back(arc.target);
+                arcs.weights.push_back(arc.weight);
+                arcs.middles.push_back(arc.middle);
+            }
+            arcs.offsets.push_back(arcs.targets.size());
+        }
+    };
+    toCsr(contractor.m_upArcs, hierarchy.m_up);
+    toCsr(contractor.m_downArcs, hierarchy.m_down);
+
+    return hierarchy;
+}
+
+/**
+ * Reads the hierarchy file into memory. Like CsrGraph::load(), the counts are checked against
+ * the file size before any of them is multiplied, then every array in one pass: the ranks are
+ * a permutation, the offsets go up to the number of arcs and every target and middle is a
+ * vertex (or no middle), so no query can index out of the arrays. The hierarchy must have been
+ * built for graph, as the ALT index checks on every query; the queries don't see the graph.
+ */
+ContractionHierarchy ContractionHierarchy::load(const std::string& filePath,
+                                                const CsrGraph& graph)
+{
+    MappedFile file{filePath};
+
+    ChFileHeader header;
+    if (file.size() < sizeof(header))
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "CH",
+                                        "too small")};
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, kChMagic, sizeof(kChMagic)) != 0)
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "CH",
+                                        "bad magic")};
+    if (header.version != kVersion)
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "CH",
+                                        fmt::format("unsupported version {}", header.version))};
+    if (header.nvertices >= kNoVertex)
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "CH",
+                                        "too many vertices")};
+
+    // each array alone must fit in the file, then the sum of their sizes cannot overflow
+    const std::size_t arcSize = 2 * sizeof(vertexid_t) + sizeof(unsigned int);
+    if (header.nvertices >= file.size() / sizeof(edgeid_t)
+            || header.nup > file.size() / arcSize || header.ndown > file.size() / arcSize
+            || file.size() != chFileSize(header.nvertices, header.nup, header.ndown))
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "CH",
+                                        "size mismatch")};
+    const std::size_t nvertices = header.nvertices;
+
+    if (graph.nvertices() != nvertices)
+        throw AlgoException{fmt::format(AlgoException::GraphIndexMismatch, "CH", nvertices,
+                                        graph.nvertices())};
+    if (graph.nedges() != header.nedges || graph.checksum() != header.checksum)
+        throw AlgoException{fmt::format(AlgoException::GraphIndexStale, "CH",
+                                        graph.nedges() != header.nedges ? "edge counts"
+                                                                        : "edges or weights")};
+
+    ContractionHierarchy hierarchy;
+    hierarchy.m_nedges = header.nedges;
+    hierarchy.m_checksum = header.checksum;
+    const char* p = file.data() + sizeof(header);
+
+    auto read = [&p](auto& vector, std::size_t n) {
+        vector.resize(n);
+        std::memcpy(vector.data(), p, n * sizeof(vector[0]));
+        p += n * sizeof(vector[0]);
+    };
+    auto throwBad = [&filePath](const std::string& what) {
+        throw AlgoException{fmt::format(AlgoException::GraphBadIndexFile, filePath, "CH", what)};
+    };
+    auto readArcs = [&read, &throwBad, nvertices](Arcs& arcs, std::size_t narcs) {
+        read(arcs.offsets, nvertices + 1);
+        read(arcs.targets, narcs);
+        read(arcs.weights, narcs);
+        read(arcs.middles, narcs);
+
+        if (arcs.offsets[0] != 0 || arcs.offsets.back() != narcs)
+            throwBad("bad offsets");
+        for (std::size_t u = 0; u < nvertices; ++u) {
+            if (arcs.offsets[u] > arcs.offsets[u + 1])
+                throwBad(fmt::format("bad offsets of vertex {}", u));
+        }
+        for (edgeid_t e = 0; e < narcs; ++e) {
+            if (arcs.targets[e] >= nvertices)
+                throwBad(fmt::format("bad target of arc {}", e));
+            if (arcs.middles[e] >= nvertices && arcs.middles[e] != kNoVertex)
+                throwBad(fmt::format("bad middle of arc {}", e));
+        }
+    };
+
+    read(hierarchy.m_rank, nvertices);
+    std::vector<bool> isRanked(nvertices, false);
+    for (vertexid_t v = 0; v < nvertices; ++v) {
+        vertexid_t rank = hierarchy.m_rank[v];
+        if (rank >= nvertices || isRanked[rank])
+            throwBad(fmt::format("bad rank of vertex {}", v));
+        isRanked[rank] = true;
+    }
+    readArcs(hierarchy.m_up, header.nup);
+    readArcs(hierarchy.m_down, header.ndown);
+
+    return hierarchy;
+}
+
+void ContractionHierarchy::save(const std::string& filePath) const
+{
+    const std::size_t nvertices = m_rank.size();
+    MappedFile file{filePath, chFileSize(nvertices, m_up.targets.size(), m_down.targets.size())};
+
+    ChFileHeader header;
+    std::memcpy(header.magic, kChMagic, sizeof(kChMagic));
+    header.version = kVersion;
+    header.reserved = 0;
+    header.nvertices = nvertices;
+    header.nup = m_up.targets.size();
+    header.ndown = m_down.targets.size();
+    header.nedges = m_nedges;
+    header.checksum = m_checksum;
+
+    char* p = file.data();
+    std::memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+
+    auto write = [&p](const auto& vector) {
+        std::memcpy(p, vector.data(), vector.size() * sizeof(vector[0]));
+        p += vector.size() * sizeof(vector[0]);
+    };
+
+    write(m_rank);
+    for (const Arcs* arcs : {&m_up, &m_down}) {
+        write(arcs->offsets);
+        write(arcs->targets);
+        write(arcs->weights);
+        write(arcs->middles);
+    }
+
+    file.commit();
+}
+
+std::size_t ContractionHierarchy::nshortcuts() const
+{
+    return std::count_if(m_up.middles.begin(), m_up.middles.end(),
+                         [](vertexid_t m) { return m != kNoVertex; })
+            + std::count_if(m_down.middles.begin(), m_down.middles.end(),
+                            [](vertexid_t m) { return m != kNoVertex; });
+}
+
+ShortestPath ContractionHierarchy::shortestPath(vertexid_t sourceVertexId,
+                                                vertexid_t targetVertexId) const
+{
+    SearchContext forward;
+    SearchContext backward;
+    return this->shortestPath(sourceVertexId, targetVertexId, forward, backward);
+}
+
+/**
+ * Bidirectional Dijkstra where both sides only go up the hierarchy, the side with the smaller
+ * queue top moves next. A side is done once its top is no less than the best path seen.
+ */
+ShortestPath ContractionHierarchy::shortestPath(vertexid_t sourceVertexId,
+                                                vertexid_t targetVertexId,
+                                                SearchContext& forward,
+                                                SearchContext& backward) const
+{
+    const std::size_t nvertices = m_rank.size();
+    if (sourceVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        sourceVertexId)};
+    if (targetVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given target vertex id, {} is not in the graph!",
+                                        targetVertexId)};
+
+    ShortestPath result;
+
+    forward.reset(nvertices);
+    backward.reset(nvertices);
+    forward.reach(sourceVertexId, 0, kNoVertex);
+    forward.heap().push(sourceVertexId, 0);
+    backward.reach(targetVertexId, 0, kNoVertex);
+    backward.heap().push(targetVertexId, 0);
+
+    unsigned int best = SearchContext::kInfinity;
+    vertexid_t meet = kNoVertex;
+
+    auto step = [&best, &meet, &result](const Arcs& arcs, SearchContext& context,
+                                        const SearchContext& other) {
+        vertexid_t v = context.heap().pop().id;
+        context.settle(v);
+        ++result.nsettled;
+
+        unsigned int distanceToV = context.distance(v);
+        if (other.isReached(v) && distanceToV + other.distance(v) < best) {
+            best = distanceToV + other.distance(v);
+            meet = v;
+        }
+
+        for (edgeid_t e = arcs.offsets[v]; e < arcs.offsets[v + 1]; ++e) {
+            vertexid_t w = arcs.targets[e];
+            unsigned int distance = distanceToV + arcs.weights[e];
+            if (distance < context.distance(w)) {
+                context.reach(w, distance, v);
+                context.heap().pushOrDecrease(w, distance);
+            }
+        }
+    };
+
+    auto isDone = [&best](const SearchContext& context) {
+        return context.heap().isEmpty() || context.heap().top().key >= best;
+    };
+
+    for (;;) {
+        bool forwardDone = isDone(forward);
+        bool backwardDone = isDone(backward);
+        if (forwardDone && backwardDone)
+            break;
+
+        if (backwardDone
+                || (!forwardDone && forward.heap().top().key <= backward.heap().top().key))
+            step(m_up, forward, backward);
+        else
+            step(m_down, backward, forward);
+    }
+
+    if (meet == kNoVertex)
+        return result;
+
+    result.distance = best;
+
+    // hierarchy path s .. meet .. t, then every shortcut replaced by its two halves
+    std::vector<vertexid_t> up = forward.path(meet);
+    result.path.push_back(up.front());
+    for (std::size_t i = 0; i + 1 < up.size(); ++i) {
+        edgeid_t e = findArc(m_up, up[i], up[i + 1]);
+        this->unpack(up[i], up[i + 1], m_up.middles[e], result.path);
+    }
+    for (vertexid_t v = meet; backward.parent(v) != kNoVertex; v = backward.parent(v)) {
+        vertexid_t w = backward.parent(v);
+        edgeid_t e = findArc(m_down, w, v);
+        this->unpack(v, w, m_down.middles[e], result.path);
+    }
+
+    return result;
+}
+
+edgeid_t ContractionHierarchy::findArc(const Arcs& arcs, vertexid_t u, vertexid_t target)
+{
+    for (edgeid_t e = arcs.offsets[u]; e < arcs.offsets[u + 1]; ++e) {
+        if (arcs.targets[e] == target)
+            return e;
+    }
+    throw AlgoException{fmt::format(AlgoException::GraphBadFormat,
+                                    fmt::format("hierarchy arc {} - {}", u, target), "none")};
+}
+
+// appends the vertices after u on the original path of the arc u -> w
+void ContractionHierarchy::unpack(vertexid_t u, vertexid_t w, vertexid_t middle,
+                                  std::vector<vertexid_t>& path) const
+{
+    if (middle == kNoVertex) {
+        path.push_back(w);
+        return;
+    }
+
+    // both halves were the arcs of middle when it got contracted
+    edgeid_t e = findArc(m_down, middle, u);
+    this->unpack(u, middle, m_down.middles[e], path);
+    e = findArc(m_up, middle, w);
+    this->unpack(middle, w, m_up.middles[e], path);
+}
+
+#ifdef UNIT_TEST
+
+namespace {
+
+// length of the path over the graph edges, kInfinity if some step isn't an edge
+unsigned int pathLength(const CsrGraph& graph, const std::vector<vertexid_t>& path)
+{
+    unsigned int length = 0;
+    for (std::size_t i = 0; i + 1 < path.size(); ++i) {
+        unsigned int shortest = SearchContext::kInfinity;
+        for (edgeid_t e = graph.edgeBegin(path[i]); e < graph.edgeEnd(path[i]); ++e) {
+            if (graph.target(e) == path[i + 1])
+                shortest = std::min(shortest, static_cast<unsigned int>(graph.weight(e)));
+        }
+        if (shortest == SearchContext::kInfinity)
+            return shortest;
+        length += shortest;
+    }
+    return length;
+}
+
+} // anonymous
+
+TEST(ContractionHierarchyTest, Query)
+{
+    // a road like grid, every street has its own length each way and some are one way
+    std::mt19937 random{12};
+    const vertexid_t side = 30;
+    const std::size_t nvertices = side * side;
+    std::uniform_int_distribution<int> lengths{1, 100};
+
+    std::vector<CsrEdge> edges;
+    for (vertexid_t v = 0; v < nvertices; ++v) {
+        for (vertexid_t w : {v % side + 1 < side ? v + 1 : v, v + side < nvertices ? v + side : v}) {
+            if (w == v)
+                continue;
+            edges.push_back(CsrEdge{v, w, lengths(random)});
+            if (lengths(random) > 10)
+                edges.push_back(CsrEdge{w, v, lengths(random)});
+        }
+    }
+    CsrGraph graph{GraphType::Directed, nvertices, edges};
+
+    ThreadPool pool{4};
+    ContractionHierarchy hierarchy = ContractionHierarchy::build(graph, pool);
+    ASSERT_EQ(nvertices, hierarchy.nvertices());
+
+    // every vertex contracted once: the ranks are a permutation
+    std::vector<bool> isRanked(nvertices, false);
+    for (vertexid_t v = 0; v < nvertices; ++v) {
+        ASSERT_LT(hierarchy.rank(v), nvertices) << v;
+        EXPECT_FALSE(isRanked[hierarchy.rank(v)]) << v;
+        isRanked[hierarchy.rank(v)] = true;
+    }
+
+    ThreadPool single{1};
+    EXPECT_EQ(hierarchy.nshortcuts(), ContractionHierarchy::build(graph, single).nshortcuts())
+        << "Hierarchy must not depend on the thread count!";
+
+    const std::string filename{"ContractionHierarchyTest.ch"};
+    hierarchy.save(filename);
+    ContractionHierarchy loaded = ContractionHierarchy::load(filename, graph);
+    // the loaded arcs are owned copies, saving back onto the file must still work
+    loaded.save(filename);
+    loaded = ContractionHierarchy::load(filename, graph);
+    std::remove(filename.c_str());
+    EXPECT_EQ(hierarchy.narcs(), loaded.narcs());
+
+    SearchContext forward;
+    SearchContext backward;
+    for (vertexid_t source : {0u, 333u, 899u}) {
+        std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, source);
+        for (vertexid_t target = 0; target < nvertices; target += 7) {
+            ShortestPath actual = hierarchy.shortestPath(source, target, forward, backward);
+            ASSERT_EQ(expected[target], actual.distance) << source << " -> " << target;
+            EXPECT_EQ(actual.distance, loaded.shortestPath(source, target).distance);
+
+            if (actual.distance != SearchContext::kInfinity) {
+                ASSERT_EQ(source, actual.path.front());
+                ASSERT_EQ(target, actual.path.back());
+                EXPECT_EQ(actual.distance, pathLength(graph, actual.path));
+            }
+        }
+    }
+}
+
+TEST(ContractionHierarchyTest, Undirected)
+{
+    ThreadPool pool{2};
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    ContractionHierarchy hierarchy = ContractionHierarchy::build(graph, pool);
+
+    for (vertexid_t source = 0; source < graph.nvertices(); ++source) {
+        std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, source);
+        for (vertexid_t target = 0; target < graph.nvertices(); ++target) {
+            ShortestPath actual = hierarchy.shortestPath(source, target);
+            EXPECT_EQ(expected[target], actual.distance) << source << " -> " << target;
+            EXPECT_EQ(actual.distance, pathLength(graph, actual.path));
+        }
+    }
+}
+
+TEST(ContractionHierarchyTest, LoadCorrupt)
+{
+    const std::string filename{"ContractionHierarchyTest.ch"};
+    ThreadPool pool{2};
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    ContractionHierarchy hierarchy = ContractionHierarchy::build(graph, pool);
+    const std::size_t nvertices = hierarchy.nvertices();
+
+    auto readAt = [&filename](std::size_t position) {
+        std::uint64_t value = 0;
+        std::ifstream stream{filename, std::ios::binary};
+        stream.seekg(position);
+        stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    };
+    hierarchy.save(filename);
+    const std::uint64_t nup = readAt(24);
+    ASSERT_GT(nup, 0u);
+    const std::size_t ranksAt = 56;
+    const std::size_t offsetsAt = ranksAt + nvertices * sizeof(vertexid_t);
+    const std::size_t targetsAt = offsetsAt + (nvertices + 1) * sizeof(edgeid_t);
+    const std::size_t middlesAt = targetsAt + 2 * nup * sizeof(vertexid_t);
+
+    // a vertex before the last one with arcs, its offset raised past the next one
+    vertexid_t u = 1;
+    while (u + 1 < nvertices && readAt(offsetsAt + (u + 1) * sizeof(edgeid_t)) == nup)
+        ++u;
+    ASSERT_LT(u + 1, nvertices);
+
+    // overwrite the bytes at position with value, every case starting from a good file
+    auto expectCorrupt = [&](std::size_t position, std::uint64_t value, std::size_t size) {
+        hierarchy.save(filename);
+        {
+            std::fstream stream{filename, std::ios::in | std::ios::out | std::ios::binary};
+            stream.seekp(position);
+            stream.write(reinterpret_cast<const char*>(&value), size);
+        }
+        EXPECT_THROW(ContractionHierarchy::load(filename, graph), AlgoException)
+            << position << " " << value;
+    };
+
+    expectCorrupt(16, std::uint64_t{1} << 32, 8);                   // more vertices than ids
+    expectCorrupt(16, std::uint64_t{1} << 30, 8);                   // nvertices over the size
+    expectCorrupt(24, std::uint64_t{1} << 62, 8);                   // nup overflowing
+    expectCorrupt(32, std::uint64_t{1} << 62, 8);                   // ndown overflowing
+    expectCorrupt(ranksAt, nvertices, 4);                           // rank out of range
+    expectCorrupt(ranksAt, hierarchy.rank(1), 4);                   // rank taken twice
+    expectCorrupt(offsetsAt + sizeof(edgeid_t), nup + 1, 8);        // beyond nup
+    expectCorrupt(offsetsAt + u * sizeof(edgeid_t), nup, 8);        // not monotone
+    expectCorrupt(targetsAt, 0x3fffffff, 4);                        // target outside the graph
+    expectCorrupt(middlesAt, nvertices, 4);                         // middle outside the graph
+
+    hierarchy.save(filename);
+    ContractionHierarchy loaded = ContractionHierarchy::load(filename, graph);
+    EXPECT_EQ(hierarchy.shortestPath(0, 3).distance, loaded.shortestPath(0, 3).distance);
+    std::remove(filename.c_str());
+}
+
+TEST(ContractionHierarchyTest, StaleIndex)
+{
+    // same vertices and edges, one edge got longer: the shortcuts may now be too short
+    std::vector<CsrEdge> edges = randomCsrEdges(200, 800, 11, {1, 100});
+    CsrGraph graph{GraphType::Directed, 200, edges};
+    ThreadPool pool{2};
+    const std::string filename{"ContractionHierarchyTest.ch"};
+    ContractionHierarchy::build(graph, pool).save(filename);
+
+    edges[17].value += 1000;
+    EXPECT_THROW(ContractionHierarchy::load(filename, CsrGraph{GraphType::Directed, 200, edges}),
+                 AlgoException);
+    edges.pop_back();
+    EXPECT_THROW(ContractionHierarchy::load(filename, CsrGraph{GraphType::Directed, 200, edges}),
+                 AlgoException);
+    EXPECT_THROW(ContractionHierarchy::load(filename, CsrGraph{GraphType::Directed, 201, edges}),
+                 AlgoException);
+
+    CsrGraph same{GraphType::Directed, 200, randomCsrEdges(200, 800, 11, {1, 100})};
+    ContractionHierarchy loaded = ContractionHierarchy::load(filename, same);
+    EXPECT_EQ(DijkstraGraph::findShortestPath(graph, 0)[1], loaded.shortestPath(0, 1).distance);
+    std::remove(filename.c_str());
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
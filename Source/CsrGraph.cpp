@@ -0,0 +1,567 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "CsrGraph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include <fmt/format.h>
+
+#include "AdjListParser.h"
+#include "AlgoException.h"
+#include "ThreadPool.h"
+
+#ifdef UNIT_TEST
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "DijkstraGraph.h"
+#include "KruskalMinSpanningGraph.h"
+#include "PrimMinSpanningGraph.h"
+#endif
+
+namespace psa {
+
+namespace {
+
+const char kCsrMagic[8] = {'P', 'S', 'A', 'C', 'S', 'R', '\0', '\0'};
+
+struct CsrFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t type;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::uint64_t nvertices;
+    std::uint64_t nedges;
+};
+
+static_assert(sizeof(CsrFileHeader) == 40, "CSR file header must be packed to 40 bytes");
+static_assert(sizeof(edgeid_t) == sizeof(std::uint64_t), "CSR file stores offsets as uint64");
+static_assert(sizeof(vertexid_t) == sizeof(std::uint32_t), "CSR file stores targets as uint32");
+static_assert(sizeof(int) == sizeof(std::int32_t), "CSR file stores weights as int32");
+
+std::size_t csrFileSize(std::size_t nvertices, std::size_t nedges, bool hasWeights)
+{
+    return sizeof(CsrFileHeader) + (nvertices + 1) * sizeof(edgeid_t)
+            + nedges * sizeof(vertexid_t) + (hasWeights ? nedges * sizeof(int) : 0);
+}
+
+} // anonymous
+
+CsrGraph::CsrGraph(GraphType type, std::size_t nvertices, const std::vector<CsrEdge>& edges)
+    : m_type{type}
+    , m_nvertices{nvertices}
+    , m_nedges{type == GraphType::Undirected ? 2 * edges.size() : edges.size()}
+{
+    bool hasWeights = std::any_of(edges.begin(), edges.end(),
+                                  [](const CsrEdge& e) { return e.value != 0; });
+
+    // count degree of every vertex, then prefix sum the counts to get the offsets
+    m_offsetStorage.assign(nvertices + 1, 0);
+    for (auto& e : edges) {
+        ++m_offsetStorage[e.u + 1];
+        if (type == GraphType::Undirected)
+            ++m_offsetStorage[e.v + 1];
+    }
+    for (std::size_t i = 0; i < nvertices; ++i)
+        m_offsetStorage[i + 1] += m_offsetStorage[i];
+
+    m_targetStorage.resize(m_nedges);
+    if (hasWeights)
+        m_weightStorage.resize(m_nedges);
+
+    std::vector<edgeid_t> next{m_offsetStorage.begin(), m_offsetStorage.end() - 1};
+    auto place = [this, hasWeights, &next](vertexid_t u, vertexid_t v, int value) {
+        edgeid_t i = next[u]++;
+        m_targetStorage[i] = v;
+        if (hasWeights)
+            m_weightStorage[i] = value;
+    };
+    for (auto& e : edges) {
+        place(e.u, e.v, e.value);
+        if (type == GraphType::Undirected)
+            place(e.v, e.u, e.value);
+    }
+
+    m_offsets = m_offsetStorage.data();
+    m_targets = m_targetStorage.data();
+    m_weights = hasWeights ? m_weightStorage.data() : nullptr;
+}
+
+CsrGraph CsrGraph::fromAdjList(const std::string& filePath)
+{
+    MappedFile file{filePath};
+
+    AdjListParser parser{file.begin(), file.end()};
+    parser.parseHeader();
+
+    std::vector<CsrEdge> edges;
+    if (parser.hasEdgeCount())
+        edges.reserve(parser.nedges());
+
+    parser.parseEdges([&edges](vertexid_t u, vertexid_t v, int value) {
+        edges.push_back(CsrEdge{u, v, value});
+    });
+
+    return CsrGraph{parser.type(), parser.nvertices(), edges};
+}
+
+/**
+ * Parses the adjacency list on all the threads of the pool. The result is identical to the
+ * single threaded fromAdjList(), including the order of the edges of every vertex.
+ */
+CsrGraph CsrGraph::fromAdjList(const std::string& filePath, ThreadPool& pool)
+{
+    MappedFile file{filePath};
+
+    AdjListParser parser{file.begin(), file.end()};
+    parser.parseHeader();
+
+    CsrGraph graph;
+    graph.m_type = parser.type();
+    graph.m_nvertices = parser.nvertices();
+    graph.build(parser.parseEdges(pool), pool);
+
+    return graph;
+}
+
+/**
+ * Merges the per thread edge lists into CSR. Every edge is known by its position g in file
+ * order; a counting pass with atomic counters and a prefix sum give the offsets, then each
+ * edge drops its key (2g for u -> v, 2g+1 for the reverse v -> u of undirected edge) into the
+ * slot of its source vertex. Sorting the keys of every vertex restores the file order before
+ * the keys are turned into targets and weights.
+ */
+void CsrGraph::build(const std::vector<std::vector<CsrEdge>>& chunks, ThreadPool& pool)
+{
+    const bool undirected = m_type == GraphType::Undirected;
+
+    std::vector<std::size_t> chunkStart(chunks.size() + 1, 0);
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+        chunkStart[c + 1] = chunkStart[c] + chunks[c].size();
+    m_nedges = undirected ? 2 * chunkStart.back() : chunkStart.back();
+
+    auto edgeAt = [&chunks, &chunkStart](std::size_t g) -> const CsrEdge& {
+        std::size_t c = std::upper_bound(chunkStart.begin(), chunkStart.end(), g)
+                - chunkStart.begin() - 1;
+        return chunks[c][g - chunkStart[c]];
+    };
+
+    std::atomic<bool> hasWeights{false};
+    std::unique_ptr<std::atomic<edgeid_t>[]> counts{new std::atomic<edgeid_t>[m_nvertices]};
+    for (std::size_t i = 0; i < m_nvertices; ++i)
+        counts[i].store(0, std::memory_order_relaxed);
+
+    pool.parallelFor(chunks.size(), [&](std::size_t c) {
+        bool weighted = false;
+        for (auto& e : chunks[c]) {
+            counts[e.u].fetch_add(1, std::memory_order_relaxed);
+            if (undirected)
+                counts[e.v].fetch_add(1, std::memory_order_relaxed);
+            weighted = weighted || e.value != 0;
+        }
+        if (weighted)
+            hasWeights = true;
+    });
+
+    // prefix sum, counts become the insert positions
+    m_offsetStorage.resize(m_nvertices + 1);
+    m_offsetStorage[0] = 0;
+    for (std::size_t i = 0; i < m_nvertices; ++i) {
+        m_offsetStorage[i + 1] = m_offsetStorage[i] + counts[i].load(std::memory_order_relaxed);
+        counts[i].store(m_offsetStorage[i], std::memory_order_relaxed);
+    }
+
+    std::vector<edgeid_t> keys(m_nedges);
+    pool.parallelFor(chunks.size(), [&](std::size_t c) {
+        edgeid_t g = chunkStart[c];
+        for (auto& e : chunks[c]) {
+            keys[counts[e.u].fetch_add(1, std::memory_order_relaxed)] = 2 * g;
+            if (undirected)
+                keys[counts[e.v].fetch_add(1, std::memory_order_relaxed)] = 2 * g + 1;
+            ++g;
+        }
+    });
+    counts.reset();
+
+    m_targetStorage.resize(m_nedges);
+    if (hasWeights)
+        m_weightStorage.resize(m_nedges);
+
+    const std::size_t nblocks = 8 * pool.size();
+    const std::size_t blockSize = m_nvertices / nblocks + 1;
+    pool.parallelFor(nblocks, [&](std::size_t b) {
+        std::size_t first = std::min(b * blockSize, m_nvertices);
+        std::size_t last = std::min(first + blockSize, m_nvertices);
+        for (std::size_t u = first; u < last; ++u) {
+            std::sort(keys.begin() + m_offsetStorage[u], keys.begin() + m_offsetStorage[u + 1]);
+            for (edgeid_t i = m_offsetStorage[u]; i < m_offsetStorage[u + 1]; ++i) {
+                const CsrEdge& e = edgeAt(keys[i] / 2);
+                m_targetStorage[i] = (keys[i] & 1) ? e.u : e.v;
+                if (hasWeights)
+                    m_weightStorage[i] = e.value;
+            }
+        }
+    });
+
+    m_offsets = m_offsetStorage.data();
+    m_targets = m_targetStorage.data();
+    m_weights = hasWeights ? m_weightStorage.data() : nullptr;
+}
+
+/**
+ * Maps the CSR file and uses it in place, nothing is parsed or copied. The header is checked
+ * against the file size, which takes no pass over the arrays so a large file opens at once.
+ * Validate::Full also runs validate(), for files that may be corrupt.
+ */
+CsrGraph CsrGraph::load(const std::string& filePath, Validate validate)
+{
+    MappedFile file{filePath};
+
+    CsrFileHeader header;
+    if (file.size() < sizeof(header))
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath, "too small")};
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, kCsrMagic, sizeof(kCsrMagic)) != 0)
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath, "bad magic")};
+    if (header.version != kVersion)
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath,
+                                        fmt::format("unsupported version {}", header.version))};
+
+    if (header.type > 1)
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath,
+                                        fmt::format("unknown graph type {}", header.type))};
+    if (header.nvertices > std::numeric_limits<vertexid_t>::max())
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath,
+                                        "too many vertices")};
+
+    // each array alone must fit in the file, then the sum of their sizes cannot overflow
+    bool hasWeights = (header.flags & kHasWeights) != 0;
+    if (header.nvertices >= file.size() / sizeof(edgeid_t)
+            || header.nedges > file.size() / sizeof(vertexid_t)
+            || file.size() != csrFileSize(header.nvertices, header.nedges, hasWeights))
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath, "size mismatch")};
+
+    CsrGraph graph;
+    graph.m_type = header.type == 0 ? GraphType::Directed : GraphType::Undirected;
+    graph.m_nvertices = header.nvertices;
+    graph.m_nedges = header.nedges;
+
+    const char* p = file.data() + sizeof(header);
+    graph.m_offsets = reinterpret_cast<const edgeid_t*>(p);
+    p += (graph.m_nvertices + 1) * sizeof(edgeid_t);
+    graph.m_targets = reinterpret_cast<const vertexid_t*>(p);
+    p += graph.m_nedges * sizeof(vertexid_t);
+    graph.m_weights = hasWeights ? reinterpret_cast<const int*>(p) : nullptr;
+
+    if (graph.m_offsets[0] != 0 || graph.m_offsets[graph.m_nvertices] != graph.m_nedges)
+        throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath, "bad offsets")};
+
+    graph.m_file = std::move(file);
+    if (validate == Validate::Full)
+        graph.validate();
+
+    return graph;
+}
+
+/**
+ * One pass over the offsets and targets makes sure every edge range and target is within the
+ * graph, so a corrupt file throws here rather than in the algorithms.
+ */
+void CsrGraph::validate() const
+{
+    const std::string& filePath = m_file.filePath();
+    for (std::size_t u = 0; u < m_nvertices; ++u) {
+        if (m_offsets[u] > m_offsets[u + 1])
+            throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath,
+                                            fmt::format("bad offsets of vertex {}", u))};
+    }
+    for (edgeid_t e = 0; e < m_nedges; ++e) {
+        if (m_targets[e] >= m_nvertices)
+            throw AlgoException{fmt::format(AlgoException::GraphBadCsrFile, filePath,
+                                            fmt::format("bad target of edge {}", e))};
+    }
+}
+
+void CsrGraph::save(const std::string& filePath) const
+{
+    MappedFile file{filePath, csrFileSize(m_nvertices, m_nedges, this->hasWeights())};
+
+    CsrFileHeader header;
+    std::memcpy(header.magic, kCsrMagic, sizeof(kCsrMagic));
+    header.version = kVersion;
+    header.type = m_type == GraphType::Directed ? 0 : 1;
+    header.flags = this->hasWeights() ? kHasWeights : 0;
+    header.reserved = 0;
+    header.nvertices = m_nvertices;
+    header.nedges = m_nedges;
+
+    char* p = file.data();
+    std::memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    std::memcpy(p, m_offsets, (m_nvertices + 1) * sizeof(edgeid_t));
+    p += (m_nvertices + 1) * sizeof(edgeid_t);
+    std::memcpy(p, m_targets, m_nedges * sizeof(vertexid_t));
+    p += m_nedges * sizeof(vertexid_t);
+    if (this->hasWeights())
+        std::memcpy(p, m_weights, m_nedges * sizeof(int));
+
+    file.commit();
+}
+
+/**
+ * Builds the transpose graph, every edge u -> v becomes v -> u. For undirected graph it is a
+ * copy of the same topology.
+ */
+CsrGraph CsrGraph::reverse() const
+{
+    CsrGraph graph;
+    graph.m_type = m_type;
+    graph.m_nvertices = m_nvertices;
+    graph.m_nedges = m_nedges;
+
+    graph.m_offsetStorage.assign(m_nvertices + 1, 0);
+    for (edgeid_t e = 0; e < m_nedges; ++e)
+        ++graph.m_offsetStorage[m_targets[e] + 1];
+    for (std::size_t i = 0; i < m_nvertices; ++i)
+        graph.m_offsetStorage[i + 1] += graph.m_offsetStorage[i];
+
+    graph.m_targetStorage.resize(m_nedges);
+    if (this->hasWeights())
+        graph.m_weightStorage.resize(m_nedges);
+
+    std::vector<edgeid_t> next{graph.m_offsetStorage.begin(), graph.m_offsetStorage.end() - 1};
+    for (vertexid_t u = 0; u < m_nvertices; ++u) {
+        for (edgeid_t e = m_offsets[u]; e < m_offsets[u + 1]; ++e) {
+            edgeid_t i = next[m_targets[e]]++;
+            graph.m_targetStorage[i] = u;
+            if (this->hasWeights())
+                graph.m_weightStorage[i] = m_weights[e];
+        }
+    }
+
+    graph.m_offsets = graph.m_offsetStorage.data();
+    graph.m_targets = graph.m_targetStorage.data();
+    graph.m_weights = this->hasWeights() ? graph.m_weightStorage.data() : nullptr;
+
+    return graph;
+}
+
+std::uint64_t CsrGraph::checksum() const
+{
+    if (!m_checksum.ready.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock{m_checksum.mutex};
+        if (!m_checksum.ready.load(std::memory_order_relaxed)) {
+            m_checksum.value = this->computeChecksum();
+            m_checksum.ready.store(true, std::memory_order_release);
+        }
+    }
+    return m_checksum.value;
+}
+
+// FNV-1a a word at a time, a pass over all the arrays
+std::uint64_t CsrGraph::computeChecksum() const
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint64_t word) { hash = (hash ^ word) * 1099511628211ull; };
+
+    mix(m_type == GraphType::Directed ? 0 : 1);
+    mix(m_nvertices);
+    for (std::size_t u = 0; u <= m_nvertices; ++u)
+        mix(m_offsets[u]);
+    for (edgeid_t e = 0; e < m_nedges; ++e)
+        mix(m_targets[e]);
+    for (edgeid_t e = 0; e < m_nedges && m_weights; ++e)
+        mix(static_cast<std::uint32_t>(m_weights[e]));
+    return hash;
+}
+
+#ifdef UNIT_TEST
+
+std::vector<CsrEdge> randomCsrEdges(std::size_t nvertices, std::size_t nedges, unsigned int seed,
+                                    std::pair<int, int> costRange)
+{
+    std::mt19937 random{seed};
+    std::uniform_int_distribution<vertexid_t> vertices{0, static_cast<vertexid_t>(nvertices - 1)};
+    std::uniform_int_distribution<int> costs{costRange.first, costRange.second};
+
+    std::vector<CsrEdge> edges;
+    edges.reserve(nedges);
+    for (std::size_t i = 0; i < nedges; ++i) {
+        vertexid_t u = vertices(random);
+        vertexid_t v = vertices(random);
+        edges.push_back(CsrEdge{u, v, costs(random)});
+    }
+    return edges;
+}
+
+CsrGraph randomCsrGraph(GraphType type, std::size_t nvertices, std::size_t nedges,
+                        unsigned int seed, std::pair<int, int> costRange)
+{
+    return CsrGraph{type, nvertices, randomCsrEdges(nvertices, nedges, seed, costRange)};
+}
+
+TEST(CsrGraphTest, Reverse)
+{
+    std::vector<CsrEdge> edges{{0, 1, 3}, {0, 2, 4}, {2, 1, 5}};
+    CsrGraph graph{GraphType::Directed, 3, edges};
+    CsrGraph reverse = graph.reverse();
+
+    ASSERT_EQ(3u, reverse.nedges());
+    EXPECT_EQ(0u, reverse.degree(0));
+    ASSERT_EQ(2u, reverse.degree(1));
+    EXPECT_EQ(0u, reverse.target(reverse.edgeBegin(1)));
+    EXPECT_EQ(3, reverse.weight(reverse.edgeBegin(1)));
+    EXPECT_EQ(2u, reverse.target(reverse.edgeBegin(1) + 1));
+    EXPECT_EQ(5, reverse.weight(reverse.edgeBegin(1) + 1));
+    ASSERT_EQ(1u, reverse.degree(2));
+    EXPECT_EQ(0u, reverse.target(reverse.edgeBegin(2)));
+}
+
+TEST(CsrGraphTest, ParallelFromAdjList)
+{
+    ThreadPool pool{4};
+    for (auto filename : {"DijkstraAdjList.txt", "MinSpanningGraphAdjList.txt",
+                          "StronglyConnectedAdjList.txt", "KargerMinCutAdjList.txt"}) {
+        CsrGraph expected = CsrGraph::fromAdjList(filename);
+        CsrGraph actual = CsrGraph::fromAdjList(filename, pool);
+
+        EXPECT_EQ(expected.type(), actual.type());
+        ASSERT_EQ(expected.nvertices(), actual.nvertices());
+        ASSERT_EQ(expected.nedges(), actual.nedges());
+        ASSERT_EQ(expected.hasWeights(), actual.hasWeights());
+        EXPECT_TRUE(std::equal(expected.offsets(), expected.offsets() + expected.nvertices() + 1,
+                               actual.offsets())) << filename;
+        EXPECT_TRUE(std::equal(expected.targets(), expected.targets() + expected.nedges(),
+                               actual.targets())) << filename;
+        if (expected.hasWeights()) {
+            EXPECT_TRUE(std::equal(expected.weights(), expected.weights() + expected.nedges(),
+                                   actual.weights())) << filename;
+        }
+    }
+}
+
+TEST(CsrGraphTest, SaveLoad)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    EXPECT_EQ(GraphType::Undirected, graph.type());
+    EXPECT_EQ(7u, graph.nvertices());
+    EXPECT_EQ(22u, graph.nedges());
+    EXPECT_TRUE(graph.hasWeights());
+
+    const std::string filename{"CsrGraphTest.csr"};
+    graph.save(filename);
+
+    CsrGraph loaded = CsrGraph::load(filename);
+    EXPECT_TRUE(loaded.isMapped());
+    EXPECT_EQ(graph.type(), loaded.type());
+    ASSERT_EQ(graph.nvertices(), loaded.nvertices());
+    ASSERT_EQ(graph.nedges(), loaded.nedges());
+    EXPECT_TRUE(std::equal(graph.offsets(), graph.offsets() + graph.nvertices() + 1,
+                           loaded.offsets()));
+    EXPECT_TRUE(std::equal(graph.targets(), graph.targets() + graph.nedges(), loaded.targets()));
+    EXPECT_TRUE(std::equal(graph.weights(), graph.weights() + graph.nedges(), loaded.weights()));
+
+    // the checksum is made on demand and survives a move
+    std::uint64_t checksum = graph.checksum();
+    EXPECT_EQ(checksum, loaded.checksum());
+    CsrGraph moved = std::move(graph);
+    EXPECT_EQ(checksum, moved.checksum());
+
+    PrimMinSpanningGraph prim;
+    prim.readCsr(loaded);
+    EXPECT_EQ(22u, prim.nedges());
+    EXPECT_EQ(39, prim.findMst());
+
+    KruskalMinSpanningGraph kruskal;
+    kruskal.readCsr(filename);
+    EXPECT_EQ(11u, kruskal.nedges());
+    EXPECT_EQ(39, kruskal.findMst());
+
+    // saving a mapped graph onto its own file reads the old file while writing the new one
+    loaded.save(filename);
+    CsrGraph resaved = CsrGraph::load(filename);
+    ASSERT_EQ(moved.nedges(), resaved.nedges());
+    EXPECT_TRUE(std::equal(moved.targets(), moved.targets() + moved.nedges(), resaved.targets()));
+    EXPECT_TRUE(std::equal(moved.weights(), moved.weights() + moved.nedges(), resaved.weights()));
+
+    std::remove(filename.c_str());
+}
+
+TEST(CsrGraphTest, LoadCorrupt)
+{
+    const std::string filename{"CsrGraphTest.csr"};
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    const std::size_t offsetsAt = 40;
+    const std::size_t targetsAt = offsetsAt + (graph.nvertices() + 1) * sizeof(edgeid_t);
+
+    // overwrite the bytes at position with value, every case starting from a good file
+    auto corrupt = [&](std::size_t position, std::uint64_t value, std::size_t size) {
+        graph.save(filename);
+        std::fstream stream{filename, std::ios::in | std::ios::out | std::ios::binary};
+        stream.seekp(position);
+        stream.write(reinterpret_cast<const char*>(&value), size);
+    };
+    auto expectCorrupt = [&](std::size_t position, std::uint64_t value, std::size_t size) {
+        corrupt(position, value, size);
+        EXPECT_THROW(CsrGraph::load(filename), AlgoException) << position << " " << value;
+    };
+    // the edges themselves are only checked by a full validation
+    auto expectCorruptEdges = [&](std::size_t position, std::uint64_t value, std::size_t size) {
+        corrupt(position, value, size);
+        CsrGraph loaded = CsrGraph::load(filename);
+        EXPECT_THROW(loaded.validate(), AlgoException) << position << " " << value;
+        EXPECT_THROW(CsrGraph::load(filename, CsrGraph::Validate::Full), AlgoException)
+            << position << " " << value;
+    };
+
+    expectCorrupt(12, 2, 4);                                      // type
+    expectCorrupt(24, std::uint64_t{1} << 61, 8);                 // more vertices than ids
+    expectCorrupt(32, std::uint64_t{1} << 62, 8);                 // nedges overflowing the size
+    expectCorrupt(offsetsAt + graph.nvertices() * sizeof(edgeid_t), 21, 8); // last offset
+    expectCorruptEdges(offsetsAt + 3 * sizeof(edgeid_t), 100, 8); // beyond nedges
+    expectCorruptEdges(offsetsAt + 3 * sizeof(edgeid_t), 0, 8);   // not monotone
+    expectCorruptEdges(targetsAt + 5 * sizeof(vertexid_t), 7, 4); // target outside the graph
+
+    graph.save(filename);
+    EXPECT_EQ(graph.nedges(), CsrGraph::load(filename, CsrGraph::Validate::Full).nedges());
+    std::remove(filename.c_str());
+}
+
+TEST(CsrGraphTest, DijkstraFromCsr)
+{
+    const std::string filename{"CsrGraphTest.csr"};
+    CsrGraph::fromAdjList("DijkstraAdjList.txt").save(filename);
+
+    DijkstraGraph graph;
+    graph.readCsr(filename);
+    EXPECT_EQ(DijkstraGraph::Type::Directed, graph.type());
+    EXPECT_EQ(19u, graph.nedges());
+
+    graph.findShortestPath(0);
+
+    std::array<int, 10> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    std::array<int, 10> actual;
+    for (int i = 0; i < 10; ++i)
+        actual[i] = graph.vertex(i)->distance();
+    EXPECT_EQ(expected, actual);
+
+    std::remove(filename.c_str());
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -5,24 +5,31 @@
 
 #include "DijkstraGraph.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
 
 #include "AlgoBase.h"
 #include "AlgoException.h"
-#include "MinHeap.h"
+#include "BucketQueue.h"
+#include "CsrGraph.h"
+#include "IndexedMinHeap.h"
+#include "RadixHeap.h"
+#include "ThreadPool.h"
 
 #ifdef UNIT_TEST
 #include <array>
+#include <chrono>
 #include <fstream>
+#include <iostream>
+#include <mutex>
 
 #include "gtest/gtest.h"
 #endif
 
 namespace psa {
 
-// LessThan function type, used for less than compare function on Dijkstra vertices
-using LessThan = bool(*)(DijkstraGraphVertex*, DijkstraGraphVertex*);
-
 DijkstraGraphEdge::DijkstraGraphEdge(edgeid_t id,
                                      DijkstraGraphVertex* u,
                                      DijkstraGraphVertex* v,
@@ -32,15 +39,6 @@ DijkstraGraphEdge::DijkstraGraphEdge(edgeid_t id,
 {
 }
 
-DijkstraGraph::~DijkstraGraph()
-{
-    for (auto edge : m_edges)
-        delete edge;
-
-    for (auto vertex : m_vertices)
-        delete vertex;
-}
-
 void DijkstraGraph::findShortestPath(vertexid_t sourceVertexId)
 {
     DijkstraGraphVertex* sourceVertex = this->vertex(sourceVertexId);
@@ -50,34 +48,388 @@ void DijkstraGraph::findShortestPath(vertexid_t sourceVertexId)
 
     sourceVertex->setDistance(0);
 
-    std::unordered_map<vertexid_t, std::size_t> heapIndexMap; // vertices to MinHeap index map
+    IndexedMinHeap<unsigned int> verticesToProcess{m_vertices.size()};
+    verticesToProcess.push(sourceVertexId, 0);
 
-    // compare function of type Compare
-    auto lessThan = [](DijkstraGraphVertex* lhs, DijkstraGraphVertex* rhs) -> bool {
-        return lhs->distance() < rhs->distance(); };
+    // a popped vertex has its final distance, no shorter path can reach it again
+    while (!verticesToProcess.isEmpty()) {
+        DijkstraGraphVertex* v = m_vertices[verticesToProcess.pop().id];
 
-    // the index done through heap indexing functor
-    MinHeap<DijkstraGraphVertex*, LessThan, HeapIndex<DijkstraGraphVertex>>
-        verticesToProcess{m_vertices, lessThan, HeapIndex<DijkstraGraphVertex>{heapIndexMap}};
+        for (auto e : v->edges()) {
+            DijkstraGraphVertex* w = e->v();
+            if (v->distance() + e->length() < w->distance()) {
+                w->setDistance(v->distance() + e->length());
+                w->setParent(v);
+                verticesToProcess.pushOrDecrease(w->id(), w->distance());
+            }
+        }
+    }
+}
 
-    std::vector<DijkstraGraphVertex*> processedVertices{m_vertices.size()}; // fill it with nullptr
+namespace {
+
+void pushOrDecrease(IndexedMinHeap<unsigned int>& heap, vertexid_t id, unsigned int key)
+{
+    heap.pushOrDecrease(id, key);
+}
+
+template<typename Queue>
+void pushOrDecrease(Queue& queue, vertexid_t id, unsigned int key)
+{
+    queue.push(id, key);
+}
+
+/**
+ * Dijkstra from the source with the state in the context. forEachEdge(v, relax) calls
+ * relax(w, length) for every edge v -> w, that's all the search needs from the topology.
+ * The monotone queues have no decreaseKey, a vertex is pushed again when its distance drops
+ * and the stale entries are skipped when popped.
+ */
+template<typename Queue, typename ForEachEdge>
+void searchShortestPath(Queue& verticesToProcess, vertexid_t sourceVertexId,
+                        SearchContext& context, ForEachEdge forEachEdge)
+{
+    context.reach(sourceVertexId, 0, SearchContext::kNoVertex);
+    verticesToProcess.push(sourceVertexId, 0);
 
     while (!verticesToProcess.isEmpty()) {
-        DijkstraGraphVertex* v = verticesToProcess.pop();
+        vertexid_t v = verticesToProcess.pop().id;
+        if (context.isSettled(v))
+            continue;
+        context.settle(v);
+
+        unsigned int distanceToV = context.distance(v);
+        forEachEdge(v, [&context, &verticesToProcess, v, distanceToV](vertexid_t w,
+                                                                       unsigned int length) {
+            unsigned int distance = distanceToV + length;
+            if (distance < context.distance(w)) {
+                context.reach(w, distance, v);
+                pushOrDecrease(verticesToProcess, w, distance);
+            }
+        });
+    }
+}
 
-        processedVertices[v->id()] = v;
+template<typename ForEachEdge>
+void searchShortestPath(ShortestPathQueue queue, vertexid_t sourceVertexId,
+                        SearchContext& context, ForEachEdge forEachEdge)
+{
+    switch (queue) {
+    case ShortestPathQueue::IndexedHeap:
+        searchShortestPath(context.heap(), sourceVertexId, context, forEachEdge);
+        break;
+    case ShortestPathQueue::RadixHeap: {
+        RadixHeap<unsigned int> verticesToProcess;
+        searchShortestPath(verticesToProcess, sourceVertexId, context, forEachEdge);
+        break;
+    }
+    case ShortestPathQueue::BucketQueue: {
+        BucketQueue<unsigned int> verticesToProcess;
+        searchShortestPath(verticesToProcess, sourceVertexId, context, forEachEdge);
+        break;
+    }
+    }
+}
 
-        for (auto e : v->edges()) {
-            DijkstraGraphVertex* w = e->v();
-            if (!processedVertices[w->id()]) {
-                if (v->distance() + e->length() < w->distance()) {
-                    w->setDistance(v->distance() + e->length());
-                    w->setParent(v);
-                    verticesToProcess.siftup(heapIndexMap[w->id()]);
+// lowers distance to value if it is smaller, @return true if it did
+bool atomicMin(std::atomic<unsigned int>& distance, unsigned int value)
+{
+    unsigned int current = distance.load(std::memory_order_relaxed);
+    while (value < current) {
+        if (distance.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+} // anonymous
+
+/**
+ * Same as findShortestPath(sourceVertexId) but the distances and parents go to the context,
+ * the vertices are left untouched so many threads can search the graph at once.
+ */
+void DijkstraGraph::findShortestPath(vertexid_t sourceVertexId, SearchContext& context,
+                                     ShortestPathQueue queue) const
+{
+    if (sourceVertexId >= m_vertices.size())
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        sourceVertexId)};
+
+    context.reset(m_vertices.size());
+    searchShortestPath(queue, sourceVertexId, context, [this](vertexid_t v, auto&& relax) {
+        for (auto e : m_vertices[v]->edges())
+            relax(e->v()->id(), e->length());
+    });
+}
+
+/**
+ * @brief DijkstraGraph::findShortestPath computes shortest path from the source vertex on CSR
+ * topology, the graph itself is not modified.
+ * @return distance of every vertex, std::numeric_limits<unsigned int>::max() if unreachable.
+ */
+std::vector<unsigned int> DijkstraGraph::findShortestPath(const CsrGraph& graph,
+                                                          vertexid_t sourceVertexId,
+                                                          ShortestPathQueue queue)
+{
+    SearchContext context;
+    DijkstraGraph::findShortestPath(graph, sourceVertexId, context, queue);
+    return context.distances();
+}
+
+/**
+ * @brief DijkstraGraph::findShortestPath on CSR topology, the graph is read only and all the
+ * query state lives in the context. A context reused for the next query needs no clearing.
+ */
+void DijkstraGraph::findShortestPath(const CsrGraph& graph, vertexid_t sourceVertexId,
+                                     SearchContext& context, ShortestPathQueue queue)
+{
+    if (sourceVertexId >= graph.nvertices())
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        sourceVertexId)};
+
+    context.reset(graph.nvertices());
+    searchShortestPath(queue, sourceVertexId, context, [&graph](vertexid_t v, auto&& relax) {
+        for (edgeid_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+            relax(graph.target(e), static_cast<unsigned int>(graph.weight(e)));
+    });
+}
+
+/**
+ * @brief DijkstraGraph::findShortestPath with parallel delta-stepping. Distances are grouped
+ * in buckets of width delta; the vertices of the lowest bucket relax their light edges
+ * (length <= delta) in parallel until the bucket stays empty, then the heavy edges of all the
+ * vertices taken out of the bucket are relaxed in parallel. Distances drop with an atomic
+ * compare and swap, so the result is the same as the sequential search.
+ * Only the non empty buckets are kept, ordered by index, so a small delta on long edges jumps
+ * straight to the next bucket with work instead of walking the empty ones.
+ * @param delta bucket width, 0 picks the longest edge over the average degree.
+ * @return distance of every vertex, std::numeric_limits<unsigned int>::max() if unreachable.
+ */
+std::vector<unsigned int> DijkstraGraph::findShortestPath(const CsrGraph& graph,
+                                                          vertexid_t sourceVertexId,
+                                                          ThreadPool& pool, unsigned int delta)
+{
+    const std::size_t nvertices = graph.nvertices();
+    if (sourceVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        sourceVertexId)};
+
+    if (delta == 0) {
+        unsigned int maxLength = 0;
+        for (edgeid_t e = 0; e < graph.nedges(); ++e)
+            maxLength = std::max(maxLength, static_cast<unsigned int>(graph.weight(e)));
+        std::size_t degree = std::max<std::size_t>(graph.nedges() / nvertices, 1);
+        delta = std::max<unsigned int>(maxLength / degree, 1);
+    }
+
+    const unsigned int infinity = std::numeric_limits<unsigned int>::max();
+    std::unique_ptr<std::atomic<unsigned int>[]> distances{
+            new std::atomic<unsigned int>[nvertices]};
+    for (std::size_t i = 0; i < nvertices; ++i)
+        distances[i].store(infinity, std::memory_order_relaxed);
+
+    std::map<unsigned int, std::vector<vertexid_t>> buckets; // non empty ones by index
+    std::vector<char> taken(nvertices, 0); // taken out of the current bucket already
+
+    distances[sourceVertexId] = 0;
+    buckets[0].push_back(sourceVertexId);
+
+    // per task lists of the vertices whose distance went down
+    std::vector<std::vector<vertexid_t>> improved;
+
+    auto relax = [&](const std::vector<vertexid_t>& vertices, bool light) {
+        const std::size_t ntasks = std::min(vertices.size() / 256 + 1, 4 * pool.size());
+        improved.resize(ntasks);
+
+        pool.parallelFor(ntasks, [&](std::size_t task) {
+            std::vector<vertexid_t>& out = improved[task];
+            out.clear();
+            std::size_t first = vertices.size() * task / ntasks;
+            std::size_t last = vertices.size() * (task + 1) / ntasks;
+            for (std::size_t i = first; i < last; ++i) {
+                vertexid_t v = vertices[i];
+                unsigned int distanceToV = distances[v].load(std::memory_order_relaxed);
+                for (edgeid_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+                    unsigned int length = static_cast<unsigned int>(graph.weight(e));
+                    if ((length <= delta) != light)
+                        continue;
+                    vertexid_t w = graph.target(e);
+                    if (atomicMin(distances[w], distanceToV + length))
+                        out.push_back(w);
                 }
             }
+        });
+
+        // a vertex lands in the bucket of its final distance for this round, older copies of
+        // it in higher buckets are skipped as stale when reached
+        unsigned int last = 0;
+        std::vector<vertexid_t>* bucket = nullptr; // improved vertices tend to share buckets
+        for (std::size_t task = 0; task < ntasks; ++task) {
+            for (vertexid_t w : improved[task]) {
+                unsigned int b = distances[w].load(std::memory_order_relaxed) / delta;
+                if (bucket == nullptr || b != last) {
+                    bucket = &buckets[b];
+                    last = b;
+                }
+                bucket->push_back(w);
+            }
+        }
+    };
+
+    std::vector<vertexid_t> frontier;
+    std::vector<vertexid_t> settled;
+    while (!buckets.empty()) {
+        auto lowest = buckets.begin();
+        const unsigned int i = lowest->first;
+        std::vector<vertexid_t>& bucket = lowest->second; // light edges may refill it
+
+        settled.clear();
+        while (!bucket.empty()) {
+            frontier.clear();
+            for (vertexid_t v : bucket) {
+                if (distances[v].load(std::memory_order_relaxed) / delta != i)
+                    continue; // moved to a lower bucket already
+                if (!taken[v])
+                    settled.push_back(v);
+                taken[v] = 1;
+                frontier.push_back(v);
+            }
+            bucket.clear();
+
+            // duplicates in the same round only cost a second relaxation
+            std::sort(frontier.begin(), frontier.end());
+            frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+
+            relax(frontier, true);
         }
+        buckets.erase(lowest); // heavy edges only reach higher buckets
+        relax(settled, false);
+
+        for (vertexid_t v : settled)
+            taken[v] = 0;
     }
+
+    std::vector<unsigned int> result(nvertices);
+    for (std::size_t i = 0; i < nvertices; ++i)
+        result[i] = distances[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * @brief DijkstraGraph::findShortestPaths runs one search per source on the pool. Every thread
+ * keeps its own context and takes the next source from a shared counter, so a slow source
+ * doesn't hold up the others; nothing of size n x sources is kept. The callback sees the
+ * context only for the duration of the call, it must copy what it needs.
+ */
+void DijkstraGraph::findShortestPaths(const CsrGraph& graph, const std::vector<vertexid_t>& sources,
+                                      ThreadPool& pool, const ShortestPathCallback& callback,
+                                      ShortestPathQueue queue)
+{
+    for (vertexid_t source : sources) {
+        if (source >= graph.nvertices())
+            throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                            source)};
+    }
+
+    std::atomic<std::size_t> nextSource{0};
+    const std::size_t nthreads = std::min(pool.size(), sources.size());
+    pool.parallelFor(nthreads, [&graph, &sources, &callback, queue, &nextSource](std::size_t) {
+        SearchContext context;
+        for (std::size_t i = nextSource++; i < sources.size(); i = nextSource++) {
+            DijkstraGraph::findShortestPath(graph, sources[i], context, queue);
+            callback(sources[i], context);
+        }
+    });
+}
+
+ShortestPath DijkstraGraph::shortestPath(const CsrGraph& graph, const CsrGraph& reverse,
+                                         vertexid_t sourceVertexId, vertexid_t targetVertexId)
+{
+    SearchContext forward;
+    SearchContext backward;
+    return DijkstraGraph::shortestPath(graph, reverse, sourceVertexId, targetVertexId,
+                                       forward, backward);
+}
+
+/**
+ * @brief DijkstraGraph::shortestPath runs bidirectional Dijkstra: a forward search from the
+ * source on graph and a backward search from the target on reverse (graph.reverse(), or the
+ * graph itself when undirected), always advancing the one with the smaller queue top. Every
+ * edge that reaches a vertex seen by the other search is a candidate path; the search stops
+ * once the two tops add up to no less than the best candidate.
+ */
+ShortestPath DijkstraGraph::shortestPath(const CsrGraph& graph, const CsrGraph& reverse,
+                                         vertexid_t sourceVertexId, vertexid_t targetVertexId,
+                                         SearchContext& forward, SearchContext& backward)
+{
+    const std::size_t nvertices = graph.nvertices();
+    if (reverse.nvertices() != nvertices)
+        throw AlgoException{fmt::format(AlgoException::GraphBadFormat,
+                                        fmt::format("reverse graph of {} vertices", nvertices),
+                                        reverse.nvertices())};
+    if (sourceVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!",
+                                        sourceVertexId)};
+    if (targetVertexId >= nvertices)
+        throw AlgoException{fmt::format("The given target vertex id, {} is not in the graph!",
+                                        targetVertexId)};
+
+    ShortestPath result;
+
+    forward.reset(nvertices);
+    backward.reset(nvertices);
+    forward.reach(sourceVertexId, 0, SearchContext::kNoVertex);
+    forward.heap().push(sourceVertexId, 0);
+    backward.reach(targetVertexId, 0, SearchContext::kNoVertex);
+    backward.heap().push(targetVertexId, 0);
+
+    unsigned int best = sourceVertexId == targetVertexId ? 0 : SearchContext::kInfinity;
+    vertexid_t meet = sourceVertexId;
+
+    // settles the top vertex of one side and relaxes its edges
+    auto step = [&best, &meet, &result](const CsrGraph& g, SearchContext& context,
+                                        const SearchContext& other) {
+        vertexid_t v = context.heap().pop().id;
+        context.settle(v);
+        ++result.nsettled;
+
+        unsigned int distanceToV = context.distance(v);
+        for (edgeid_t e = g.edgeBegin(v); e < g.edgeEnd(v); ++e) {
+            vertexid_t w = g.target(e);
+            unsigned int distance = distanceToV + static_cast<unsigned int>(g.weight(e));
+            if (distance < context.distance(w)) {
+                context.reach(w, distance, v);
+                context.heap().pushOrDecrease(w, distance);
+            }
+            if (other.isReached(w) && distance + other.distance(w) < best) {
+                best = distance + other.distance(w);
+                meet = w;
+            }
+        }
+    };
+
+    while (!forward.heap().isEmpty() && !backward.heap().isEmpty()) {
+        unsigned int forwardTop = forward.heap().top().key;
+        unsigned int backwardTop = backward.heap().top().key;
+        if (best != SearchContext::kInfinity && forwardTop + backwardTop >= best)
+            break;
+
+        if (forwardTop <= backwardTop)
+            step(graph, forward, backward);
+        else
+            step(reverse, backward, forward);
+    }
+
+    if (best == SearchContext::kInfinity)
+        return result;
+
+    result.distance = best;
+    result.path = forward.path(meet);
+    for (vertexid_t v = backward.parent(meet); v != SearchContext::kNoVertex;
+            v = backward.parent(v))
+        result.path.push_back(v);
+
+    return result;
 }
 
 #ifdef UNIT_TEST
@@ -103,6 +455,292 @@ TEST(DijkstraGraphTest, ShortestPath)
     EXPECT_EQ(expected, actual);
 }
 
+TEST(DijkstraGraphTest, ShortestPathMappedFile)
+{
+    DijkstraGraph graph;
+    graph.readAdjList(std::string{"DijkstraAdjList.txt"});
+
+    graph.findShortestPath(0);
+
+    std::array<int, 10> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    std::array<int, 10> actual;
+    for (int i = 0; i < 10; ++i)
+        actual[i] = graph.vertex(i)->distance();
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(DijkstraGraphTest, ShortestPathParallelRead)
+{
+    ThreadPool pool{3};
+    DijkstraGraph graph;
+    graph.readAdjList("DijkstraAdjList.txt", pool);
+    EXPECT_EQ(19u, graph.nedges());
+
+    graph.findShortestPath(0);
+
+    std::array<int, 10> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    std::array<int, 10> actual;
+    for (int i = 0; i < 10; ++i)
+        actual[i] = graph.vertex(i)->distance();
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(DijkstraGraphTest, CsrShortestPath)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("DijkstraAdjList.txt");
+
+    std::vector<unsigned int> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    EXPECT_EQ(expected, DijkstraGraph::findShortestPath(graph, 0));
+}
+
+TEST(DijkstraGraphTest, ShortestPathContext)
+{
+    DijkstraGraph graph;
+    graph.readAdjList("DijkstraAdjList.txt");
+
+    SearchContext context;
+    graph.findShortestPath(0, context);
+
+    std::vector<unsigned int> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    EXPECT_EQ(expected, context.distances());
+    EXPECT_EQ(SearchContext::kInfinity, graph.vertex(9)->distance()) << "Graph must not change!";
+
+    std::vector<vertexid_t> path = context.path(9);
+    ASSERT_FALSE(path.empty());
+    EXPECT_EQ(0u, path.front());
+    EXPECT_EQ(9u, path.back());
+}
+
+TEST(DijkstraGraphTest, CsrConcurrentQueries)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("DijkstraAdjList.txt");
+
+    std::vector<std::vector<unsigned int>> expected;
+    for (vertexid_t s = 0; s < graph.nvertices(); ++s)
+        expected.push_back(DijkstraGraph::findShortestPath(graph, s));
+
+    // every task reuses its context for all the sources
+    const std::size_t ntasks = 8;
+    std::vector<std::vector<std::vector<unsigned int>>> actual(ntasks);
+    ThreadPool pool{4};
+    pool.parallelFor(ntasks, [&graph, &actual](std::size_t task) {
+        SearchContext context;
+        for (vertexid_t s = 0; s < graph.nvertices(); ++s) {
+            DijkstraGraph::findShortestPath(graph, s, context);
+            actual[task].push_back(context.distances());
+        }
+    });
+
+    for (auto& distances : actual)
+        EXPECT_EQ(expected, distances);
+}
+
+TEST(DijkstraGraphTest, MultipleSources)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("DijkstraAdjList.txt");
+
+    std::vector<vertexid_t> sources;
+    for (vertexid_t s = 0; s < graph.nvertices(); ++s)
+        sources.push_back(s);
+    sources.push_back(0);
+
+    std::mutex mutex;
+    std::vector<std::vector<unsigned int>> actual(graph.nvertices());
+    std::vector<std::size_t> ncalls(graph.nvertices(), 0);
+    ThreadPool pool{4};
+    DijkstraGraph::findShortestPaths(graph, sources, pool,
+            [&mutex, &actual, &ncalls](vertexid_t source, const SearchContext& context) {
+        std::vector<unsigned int> distances = context.distances();
+        std::lock_guard<std::mutex> lock{mutex};
+        actual[source] = std::move(distances);
+        ++ncalls[source];
+    });
+
+    EXPECT_EQ(2u, ncalls[0]);
+    for (vertexid_t s = 0; s < graph.nvertices(); ++s)
+        EXPECT_EQ(DijkstraGraph::findShortestPath(graph, s), actual[s]) << "source " << s;
+
+    bool passed = false;
+    try {
+        DijkstraGraph::findShortestPaths(graph, {0, static_cast<vertexid_t>(graph.nvertices())},
+                                         pool, [](vertexid_t, const SearchContext&) {});
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "A source not in the graph should throw!";
+}
+
+TEST(DijkstraGraphTest, QueueStrategies)
+{
+    const std::array<ShortestPathQueue, 3> queues{ShortestPathQueue::IndexedHeap,
+                                                  ShortestPathQueue::RadixHeap,
+                                                  ShortestPathQueue::BucketQueue};
+
+    DijkstraGraph small;
+    small.readAdjList("DijkstraAdjList.txt");
+
+    SearchContext context;
+    std::vector<unsigned int> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    for (auto queue : queues) {
+        small.findShortestPath(0, context, queue);
+        EXPECT_EQ(expected, context.distances());
+    }
+
+    // random graphs with long and short edges, the second one suits Dial's buckets
+    const std::size_t nvertices = 2000;
+    for (int maxLength : {100000, 10}) {
+        CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 10 * nvertices,
+                                        2016 + maxLength, {0, maxLength});
+
+        for (vertexid_t source : {0u, 7u, 1999u}) {
+            std::vector<unsigned int> distances = DijkstraGraph::findShortestPath(graph, source);
+            for (auto queue : queues)
+                EXPECT_EQ(distances, DijkstraGraph::findShortestPath(graph, source, queue));
+        }
+    }
+}
+
+// times every queue strategy over the sources, each result checked against the indexed heap
+void timeQueueStrategies(const CsrGraph& graph, const std::vector<vertexid_t>& sources,
+                         const std::string& name)
+{
+    const std::array<std::pair<ShortestPathQueue, const char*>, 3> queues{{
+            {ShortestPathQueue::IndexedHeap, "IndexedHeap"},
+            {ShortestPathQueue::RadixHeap, "RadixHeap"},
+            {ShortestPathQueue::BucketQueue, "BucketQueue"}}};
+
+    std::vector<std::vector<unsigned int>> expected;
+    for (vertexid_t source : sources)
+        expected.push_back(DijkstraGraph::findShortestPath(graph, source));
+
+    SearchContext context;
+    for (auto& queue : queues) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            DijkstraGraph::findShortestPath(graph, sources[i], context, queue.first);
+            EXPECT_EQ(expected[i], context.distances())
+                << queue.second << ", source " << sources[i];
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+        std::cout << name << " " << queue.second << ": "
+                  << elapsed.count() / sources.size() << " ms per search" << std::endl;
+    }
+}
+
+// run with --gtest_also_run_disabled_tests, needs the AlgoClass file like the other AlgoClass tests
+TEST(DijkstraGraphTest, DISABLED_AlgoClassQueueStrategiesBenchmark)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("AlgoClassDijkstraAdjList.txt");
+
+    std::vector<vertexid_t> sources;
+    for (vertexid_t s = 0; s < graph.nvertices(); ++s)
+        sources.push_back(s);
+    timeQueueStrategies(graph, sources, "AlgoClass");
+}
+
+TEST(DijkstraGraphTest, DISABLED_QueueStrategiesBenchmark)
+{
+    const std::size_t nvertices = 1 << 20;
+    for (int maxLength : {100000, 100, 10}) {
+        CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 8 * nvertices,
+                                        2016 + maxLength, {1, maxLength});
+        timeQueueStrategies(graph, {0u, 12345u, 654321u},
+                            fmt::format("{} vertices, lengths [1, {}]", nvertices, maxLength));
+    }
+}
+
+TEST(DijkstraGraphTest, DeltaStepping)
+{
+    const std::size_t nvertices = 3000;
+    for (int maxLength : {1000, 5, 0}) {
+        CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 8 * nvertices,
+                                        32 + maxLength, {0, maxLength});
+
+        for (std::size_t nthreads : {1, 4}) {
+            ThreadPool pool{nthreads};
+            for (vertexid_t source : {0u, 1234u}) {
+                std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, source);
+                for (unsigned int delta : {0u, 1u, 50u, 100000u})
+                    EXPECT_EQ(expected, DijkstraGraph::findShortestPath(graph, source, pool, delta))
+                        << "max length " << maxLength << ", delta " << delta;
+            }
+        }
+    }
+
+    ThreadPool pool{2};
+    CsrGraph graph = CsrGraph::fromAdjList("DijkstraAdjList.txt");
+    std::vector<unsigned int> expected{0, 10, 6, 7, 5, 13, 9, 16, 20, 19};
+    EXPECT_EQ(expected, DijkstraGraph::findShortestPath(graph, 0, pool));
+}
+
+TEST(DijkstraGraphTest, DeltaSteppingLongEdges)
+{
+    // a chain of 1000 edges of about 1e6 with shortcuts, delta 1 leaves ~1e9 buckets empty
+    const std::size_t nvertices = 1001;
+    std::vector<CsrEdge> edges;
+    for (vertexid_t u = 0; u + 1 < nvertices; ++u) {
+        edges.push_back(CsrEdge{u, u + 1, 1000000 + static_cast<int>(u % 7)});
+        if (u + 3 < nvertices)
+            edges.push_back(CsrEdge{u, u + 3, 3000000 + static_cast<int>(u % 5)});
+    }
+    CsrGraph graph{GraphType::Directed, nvertices, edges};
+
+    std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, 0);
+    ThreadPool pool{2};
+    for (unsigned int delta : {1u, 3u, 999999u})
+        EXPECT_EQ(expected, DijkstraGraph::findShortestPath(graph, 0, pool, delta))
+            << "delta " << delta;
+}
+
+TEST(DijkstraGraphTest, BidirectionalShortestPath)
+{
+    const std::size_t nvertices = 2000;
+    CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, 3 * nvertices, 10, {1, 100});
+    CsrGraph reverse = graph.reverse();
+
+    SearchContext forward;
+    SearchContext backward;
+    for (vertexid_t source : {0u, 500u, 1999u}) {
+        std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, source);
+        for (vertexid_t target = 0; target < nvertices; target += 37) {
+            ShortestPath actual = DijkstraGraph::shortestPath(graph, reverse, source, target,
+                                                              forward, backward);
+            ASSERT_EQ(expected[target], actual.distance) << source << " -> " << target;
+            if (expected[target] == SearchContext::kInfinity) {
+                EXPECT_TRUE(actual.path.empty());
+                continue;
+            }
+
+            // path must be made of graph edges adding up to the distance
+            ASSERT_EQ(source, actual.path.front());
+            ASSERT_EQ(target, actual.path.back());
+            unsigned int length = 0;
+            for (std::size_t i = 0; i + 1 < actual.path.size(); ++i) {
+                unsigned int shortest = SearchContext::kInfinity;
+                vertexid_t u = actual.path[i];
+                for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                    if (graph.target(e) == actual.path[i + 1])
+                        shortest = std::min(shortest, static_cast<unsigned int>(graph.weight(e)));
+                }
+                ASSERT_NE(SearchContext::kInfinity, shortest);
+                length += shortest;
+            }
+            EXPECT_EQ(actual.distance, length);
+        }
+    }
+
+    CsrGraph small = CsrGraph::fromAdjList("DijkstraAdjList.txt");
+    ShortestPath path = DijkstraGraph::shortestPath(small, small.reverse(), 0, 8);
+    EXPECT_EQ(20u, path.distance);
+    EXPECT_EQ(0u, path.path.front());
+    EXPECT_EQ(8u, path.path.back());
+
+    path = DijkstraGraph::shortestPath(small, small.reverse(), 3, 3);
+    EXPECT_EQ(0u, path.distance);
+    EXPECT_EQ(std::vector<vertexid_t>{3}, path.path);
+}
+
 TEST(DijkstraGraphTest, AlgoClassShortestPath)
 {
     const std::string filename{"AlgoClassDijkstraAdjList.txt"};
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "DistanceMatrix.h"
+
+#include <algorithm>
+
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+#ifdef UNIT_TEST
+#include <gtest/gtest.h>
+
+#include "DijkstraGraph.h"
+#endif
+
+namespace psa {
+
+const std::size_t DistanceMatrix::kTileSize;
+const unsigned int DistanceMatrix::kInfinity;
+const unsigned int DistanceMatrix::kUnreachable;
+
+DistanceMatrix::DistanceMatrix(std::size_t nvertices)
+    : m_nvertices{nvertices}
+    , m_stride{(nvertices + kTileSize - 1) / kTileSize * kTileSize}
+    , m_distances(m_stride * m_stride, kUnreachable)
+{
+    for (std::size_t v = 0; v < m_stride; ++v)
+        m_distances[v * m_stride + v] = 0;
+}
+
+DistanceMatrix DistanceMatrix::fromGraph(const CsrGraph& graph)
+{
+    DistanceMatrix matrix{graph.nvertices()};
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            unsigned int length = static_cast<unsigned int>(graph.weight(e));
+            if (length < matrix.m_distances[u * matrix.m_stride + v])
+                matrix.setDistance(u, v, length);
+        }
+    }
+    return matrix;
+}
+
+DistanceMatrix DistanceMatrix::findShortestPaths(const CsrGraph& graph, ThreadPool& pool)
+{
+    DistanceMatrix matrix = DistanceMatrix::fromGraph(graph);
+    matrix.findShortestPaths(pool);
+    return matrix;
+}
+
+/**
+ * Blocked Floyd-Warshall. Within block k, the diagonal tile depends only on itself, the tiles
+ * of row k and column k only on themselves and the diagonal one, and the rest only on row k
+ * and column k; so the last two phases have no tile written by two tasks.
+ */
+void DistanceMatrix::findShortestPaths(ThreadPool& pool)
+{
+    const std::size_t ntiles = m_stride / kTileSize;
+
+    for (std::size_t k = 0; k < ntiles; ++k) {
+        this->relaxTile(k, k, k);
+
+        if (ntiles == 1)
+            break;
+
+        // tile t < ntiles - 1 of row k, then of column k, skipping the diagonal one
+        pool.parallelFor(2 * (ntiles - 1), [this, ntiles, k](std::size_t t) {
+            std::size_t other = t % (ntiles - 1);
+            other += other >= k;
+            if (t < ntiles - 1)
+                this->relaxTile(k, other, k);
+            else
+                this->relaxTile(other, k, k);
+        });
+
+        pool.parallelFor((ntiles - 1) * (ntiles - 1), [this, ntiles, k](std::size_t t) {
+            std::size_t i = t / (ntiles - 1);
+            std::size_t j = t % (ntiles - 1);
+            this->relaxTile(i + (i >= k), j + (j >= k), k);
+        });
+    }
+}
+
+/**
+ * Row kk of the k tile is copied out first: c is the same tile as b when i == k, and with a
+ * local row the compiler needs no runtime overlap check to vectorize the min-plus loop.
+ */
+void DistanceMatrix::relaxTile(std::size_t i, std::size_t j, std::size_t k)
+{
+    unsigned int* c = &m_distances[i * kTileSize * m_stride + j * kTileSize];
+    const unsigned int* a = &m_distances[i * kTileSize * m_stride + k * kTileSize];
+    const unsigned int* b = &m_distances[k * kTileSize * m_stride + j * kTileSize];
+    unsigned int bRow[kTileSize];
+
+    for (std::size_t kk = 0; kk < kTileSize; ++kk) {
+        std::copy(b + kk * m_stride, b + kk * m_stride + kTileSize, bRow);
+        for (std::size_t ii = 0; ii < kTileSize; ++ii) {
+            unsigned int aik = a[ii * m_stride + kk];
+            unsigned int* cRow = c + ii * m_stride;
+            for (std::size_t jj = 0; jj < kTileSize; ++jj)
+                cRow[jj] = std::min(cRow[jj], aik + bRow[jj]);
+        }
+    }
+}
+
+#ifdef UNIT_TEST
+
+TEST(DistanceMatrixTest, FloydWarshall)
+{
+    // spans a few tiles with a partial last one, some vertices unreachable
+    const std::size_t nvertices = 3 * DistanceMatrix::kTileSize + 5;
+    CsrGraph graph{GraphType::Directed, nvertices,
+                   randomCsrEdges(nvertices - 10, 4 * nvertices, 14, {1, 100})};
+
+    ThreadPool pool{4};
+    DistanceMatrix matrix = DistanceMatrix::findShortestPaths(graph, pool);
+    ASSERT_EQ(nvertices, matrix.nvertices());
+
+    for (vertexid_t u = 0; u < nvertices; ++u) {
+        std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, u);
+        for (vertexid_t v = 0; v < nvertices; ++v)
+            ASSERT_EQ(expected[v], matrix.distance(u, v)) << u << " -> " << v;
+    }
+}
+
+TEST(DistanceMatrixTest, AdjListGraphs)
+{
+    ThreadPool pool{2};
+    for (const char* fileName : {"DijkstraAdjList.txt", "MinSpanningGraphAdjList.txt"}) {
+        CsrGraph graph = CsrGraph::fromAdjList(fileName);
+        DistanceMatrix matrix = DistanceMatrix::findShortestPaths(graph, pool);
+
+        for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+            std::vector<unsigned int> expected = DijkstraGraph::findShortestPath(graph, u);
+            for (vertexid_t v = 0; v < graph.nvertices(); ++v) {
+                EXPECT_EQ(expected[v], matrix.distance(u, v))
+                        << fileName << " " << u << " -> " << v;
+            }
+        }
+    }
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
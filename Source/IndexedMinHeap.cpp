@@ -0,0 +1,109 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "IndexedMinHeap.h"
+
+#ifdef UNIT_TEST
+#include <algorithm>
+#include <random>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+#ifdef UNIT_TEST
+
+template<unsigned int Arity>
+static void checkHeapSort()
+{
+    const std::size_t n = 1000;
+    std::mt19937 random{42};
+    std::uniform_int_distribution<int> keys{0, 10000};
+
+    std::vector<int> expected(n);
+    IndexedMinHeap<int, Arity> heap{n};
+    for (vertexid_t id = 0; id < n; ++id) {
+        expected[id] = keys(random);
+        heap.push(id, expected[id] + 5000);
+    }
+
+    // lower every key back to its expected value, half with each API
+    for (vertexid_t id = 0; id < n; ++id) {
+        if (id % 2)
+            heap.decreaseKey(id, expected[id]);
+        else
+            EXPECT_TRUE(heap.pushOrDecrease(id, expected[id]));
+        EXPECT_FALSE(heap.pushOrDecrease(id, expected[id] + 1));
+    }
+    EXPECT_EQ(n, heap.size());
+
+    std::vector<int> actual;
+    while (!heap.isEmpty()) {
+        auto entry = heap.pop();
+        EXPECT_EQ(expected[entry.id], entry.key);
+        EXPECT_FALSE(heap.contains(entry.id));
+        actual.push_back(entry.key);
+    }
+
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(IndexedMinHeapTest, Arity)
+{
+    checkHeapSort<2>();
+    checkHeapSort<4>();
+    checkHeapSort<8>();
+}
+
+TEST(IndexedMinHeapTest, Reuse)
+{
+    IndexedMinHeap<unsigned int> heap{4};
+    heap.push(3, 30);
+    heap.push(1, 10);
+    EXPECT_TRUE(heap.contains(3));
+    EXPECT_EQ(10u, heap.top().key);
+
+    heap.reset(8);
+    EXPECT_TRUE(heap.isEmpty());
+    EXPECT_EQ(8u, heap.capacity());
+    for (vertexid_t id = 0; id < 8; ++id)
+        EXPECT_FALSE(heap.contains(id));
+
+    heap.push(7, 1);
+    EXPECT_EQ(7u, heap.pop().id);
+
+    bool passed = false;
+    try {
+        heap.pop();
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "Pop on an empty heap should throw!";
+
+    passed = false;
+    try {
+        heap.decreaseKey(2, 0);
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "decreaseKey of an id not in the heap should throw!";
+
+    heap.push(2, 20);
+    passed = false;
+    try {
+        heap.decreaseKey(2, 21);
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "decreaseKey to a larger key should throw!";
+    heap.decreaseKey(2, 20);
+    EXPECT_EQ(20u, heap.top().key);
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -21,14 +21,14 @@ KargerMinCutGraph::KargerMinCutGraph(const KargerMinCutGraph& rhs)
 {
     m_vertices.reserve(rhs.m_vertices.size());
     for (auto vertex : rhs.m_vertices)
-        m_vertices.push_back(new KargerMinCutGraphVertex{vertex->id()});
+        m_vertices.push_back(this->createVertex(vertex->id()));
 
     m_edges.reserve(rhs.m_edges.size());
     for (auto edge : rhs.m_edges) {
         auto u = this->vertex(edge->u()->id());
         auto v = this->vertex(edge->v()->id());
 
-        m_edges.push_back(new Edge<KargerMinCutGraphVertex>{edge->id(), u, v});
+        m_edges.push_back(this->createEdge(edge->id(), u, v));
     }
 
     for (auto rhsVertex : rhs.m_vertices) {
@@ -39,15 +39,6 @@ KargerMinCutGraph::KargerMinCutGraph(const KargerMinCutGraph& rhs)
     }
 }
 
-KargerMinCutGraph::~KargerMinCutGraph()
-{
-    for (auto edge : m_edges)
-        delete edge;
-
-    for (auto vertex : m_vertices)
-        delete vertex;
-}
-
 std::size_t KargerMinCutGraph::minCut()
 {
     KargerMinCutGraph g = *this;
@@ -76,7 +67,7 @@ std::size_t KargerMinCutGraph::contract()
         auto u = this->vertex(e->u()->id());
         auto v = this->vertex(e->v()->id());
 
-        auto newVertex = new KargerMinCutGraphVertex{static_cast<vertexid_t>(m_vertices.size())};
+        auto newVertex = this->createVertex(static_cast<vertexid_t>(m_vertices.size()));
 
         this->adjustEdges(u, v, newVertex);
         this->adjustEdges(v, u, newVertex);
@@ -140,12 +131,9 @@ void KargerMinCutGraph::resetWith(const KargerMinCutGraph& rhs)
         edge->setV(v);
     }
 
-    std::size_t nInterVertices = m_vertices.size() - rhs.m_vertices.size();
-    while (nInterVertices > 0) {
-        delete m_vertices.back();
-        m_vertices.pop_back();
-        --nInterVertices;
-    }
+    // the contracted vertices are the most recently created ones
+    this->releaseVertices(rhs.m_vertices.size());
+    m_vertices.resize(rhs.m_vertices.size());
 
     for (auto rhsVertex : rhs.m_vertices) {
         auto vertex = this->vertex(rhsVertex->id());
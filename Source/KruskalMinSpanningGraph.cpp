@@ -5,25 +5,44 @@
 
 #include "KruskalMinSpanningGraph.h"
 
-#include <forward_list>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+#include <stdlib.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "CsrGraph.h"
+#include "MinHeap.h"
+#include "Sorting.h"
+#include "ThreadPool.h"
+#include "UnionFind.h"
 
 #ifdef UNIT_TEST
+#include <cstdio>
 #include <fstream>
+#include <set>
+
+#include <sys/resource.h>
 
-#include <fmt/format.h>
 #include <gtest/gtest.h>
 #endif
 
 namespace psa {
 
-KruskalMinSpanningGraph::~KruskalMinSpanningGraph()
-{
-    for (auto edge : m_edges)
-        delete edge;
-
-    for (auto vertex : m_vertices)
-        delete vertex;
-}
+const int KruskalMinSpanningGraph::kNoSpacing;
+const std::size_t KruskalMinSpanningGraph::kMinMemoryBudget;
+const std::size_t KruskalMinSpanningGraph::kIoBufferSize;
 
 long KruskalMinSpanningGraph::findMst()
 {
@@ -34,52 +53,735 @@ long KruskalMinSpanningGraph::findMst()
                 { return lhs->cost() < rhs->cost(); };
     std::sort(m_edges.begin(), m_edges.end(), cmp);
 
+    UnionFind leaders{m_vertices.size()};
     for (auto e : m_edges) {
-        KruskalMinSpanningGraphVertex* uleader = this->findLeader(e->u());
-        KruskalMinSpanningGraphVertex* vleader = this->findLeader(e->v());
-        if (uleader != vleader) {
+        if (leaders.unite(e->u()->id(), e->v()->id()))
             cost += e->cost();
-            this->unionLeaders(uleader, vleader);
+    }
+
+    return cost;
+}
+
+/**
+ * @brief KruskalMinSpanningGraph::findMst on CSR topology, every undirected edge is taken once.
+ * @return cost of the minimum spanning forest.
+ */
+long KruskalMinSpanningGraph::findMst(const CsrGraph& graph)
+{
+    std::vector<CsrEdge> edges;
+    edges.reserve(graph.type() == GraphType::Undirected ? graph.nedges() / 2 : graph.nedges());
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            if (graph.type() == GraphType::Directed || u < v)
+                edges.push_back(CsrEdge{u, v, graph.weight(e)});
         }
     }
+    std::sort(edges.begin(), edges.end(),
+              [](const CsrEdge& lhs, const CsrEdge& rhs) { return lhs.value < rhs.value; });
+
+    long cost = 0;
+    UnionFind leaders{graph.nvertices()};
+    for (auto& e : edges) {
+        if (leaders.unite(e.u, e.v))
+            cost += e.value;
+    }
+
+    return cost;
+}
+
+namespace {
+
+// an edge with its cost mapped by radixKey()
+struct KeyedEdge
+{
+    std::uint32_t key;
+    vertexid_t u;
+    vertexid_t v;
+};
+
+// parts smaller than this are sorted, larger ones split
+const std::size_t kFilterBaseSize = 1 << 16;
+
+class FilterKruskal
+{
+public:
+    FilterKruskal(std::size_t nvertices, std::size_t nedges, ThreadPool& pool)
+        : m_leaders{nvertices}
+        , m_pool{pool}
+        , m_buffer(nedges)
+        , m_nlefts(pool.size())
+        , m_nrights(pool.size())
+    {}
+
+    long run(std::vector<KeyedEdge>& edges, std::size_t first, std::size_t last);
+
+private:
+    long kruskal(std::vector<KeyedEdge>& edges, std::size_t first, std::size_t last);
+
+    template<typename IsLeft>
+    std::size_t partition(std::vector<KeyedEdge>& edges, std::size_t first, std::size_t last,
+                          IsLeft isLeft, bool dropRest);
+
+    UnionFind m_leaders;
+    ThreadPool& m_pool;
+    std::mt19937 m_random{0};
+    std::vector<KeyedEdge> m_buffer;
+    std::vector<std::size_t> m_nlefts;
+    std::vector<std::size_t> m_nrights;
+};
+
+/**
+ * Stable partition of [first, last) on the pool, the same way radixSort() scatters: the threads
+ * count the edges of their chunk that isLeft, the counts are prefix summed, and every thread
+ * copies its chunk to its own offsets in the buffer, which is copied back. The edges that are
+ * not isLeft go after the others or, if dropRest, nowhere. The end of the left edges.
+ */
+template<typename IsLeft>
+std::size_t FilterKruskal::partition(std::vector<KeyedEdge>& edges, std::size_t first,
+                                     std::size_t last, IsLeft isLeft, bool dropRest)
+{
+    const std::size_t n = last - first;
+    const KeyedEdge* input = edges.data() + first;
+    KeyedEdge* output = m_buffer.data() + first;
+
+    const std::size_t ntasks = m_pool.parallelForChunks(n, [&](std::size_t task,
+                                                               std::size_t begin,
+                                                               std::size_t end) {
+        std::size_t count = 0;
+        for (std::size_t i = begin; i < end; ++i)
+            count += isLeft(input[i]);
+        m_nlefts[task] = count;
+        m_nrights[task] = end - begin - count;
+    });
+
+    std::size_t nleft = 0;
+    for (std::size_t task = 0; task < ntasks; ++task) {
+        std::size_t count = m_nlefts[task];
+        m_nlefts[task] = nleft;
+        nleft += count;
+    }
+    std::size_t nright = nleft;
+    for (std::size_t task = 0; task < ntasks; ++task) {
+        std::size_t count = m_nrights[task];
+        m_nrights[task] = nright;
+        nright += count;
+    }
+
+    // the same chunks as counted, so each one finds its own offsets
+    m_pool.parallelForChunks(n, [&](std::size_t task, std::size_t begin, std::size_t end) {
+        std::size_t left = m_nlefts[task];
+        std::size_t right = m_nrights[task];
+        for (std::size_t i = begin; i < end; ++i) {
+            if (isLeft(input[i]))
+                output[left++] = input[i];
+            else if (!dropRest)
+                output[right++] = input[i];
+        }
+    });
+    m_pool.parallelForChunks(dropRest ? nleft : n, [&](std::size_t, std::size_t begin,
+                                                       std::size_t end) {
+        std::copy(output + begin, output + end, edges.begin() + first + begin);
+    });
+    return first + nleft;
+}
+
+long FilterKruskal::kruskal(std::vector<KeyedEdge>& edges, std::size_t first, std::size_t last)
+{
+    std::vector<KeyedEdge> part{edges.begin() + first, edges.begin() + last};
+    radixSort(part, [](const KeyedEdge& e) { return e.key; }, m_pool);
 
+    long cost = 0;
+    for (auto& e : part) {
+        if (m_leaders.unite(e.u, e.v))
+            cost += static_cast<int>(e.key ^ 0x80000000u);
+    }
     return cost;
 }
 
-KruskalMinSpanningGraphVertex* KruskalMinSpanningGraph::findLeader(
-        KruskalMinSpanningGraphVertex* v)
+long FilterKruskal::run(std::vector<KeyedEdge>& edges, std::size_t first, std::size_t last)
+{
+    if (m_leaders.nsets() == 1)
+        return 0;
+    if (last - first <= kFilterBaseSize)
+        return this->kruskal(edges, first, last);
+
+    // median of three sampled costs
+    std::uniform_int_distribution<std::size_t> positions{first, last - 1};
+    std::uint32_t samples[3] = {edges[positions(m_random)].key, edges[positions(m_random)].key,
+                                edges[positions(m_random)].key};
+    std::sort(samples, samples + 3);
+    const std::uint32_t pivot = samples[1];
+
+    std::size_t split = this->partition(edges, first, last,
+                                        [pivot](const KeyedEdge& e) { return e.key <= pivot; },
+                                        false);
+    if (split == last)
+        return this->kruskal(edges, first, last);
+
+    long cost = this->run(edges, first, split);
+
+    // the finds only read, the threads share the union-find
+    std::size_t end = this->partition(edges, split, last, [this](const KeyedEdge& e) {
+        return m_leaders.root(e.u) != m_leaders.root(e.v);
+    }, true);
+    return cost + this->run(edges, split, end);
+}
+
+} // anonymous
+
+long KruskalMinSpanningGraph::findMst(const CsrGraph& graph, ThreadPool& pool)
+{
+    std::vector<KeyedEdge> edges;
+    edges.reserve(graph.type() == GraphType::Undirected ? graph.nedges() / 2 : graph.nedges());
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            if ((graph.type() == GraphType::Directed || u < v) && u != v)
+                edges.push_back(KeyedEdge{radixKey(graph.weight(e)), u, v});
+        }
+    }
+
+    FilterKruskal filterKruskal{graph.nvertices(), edges.size(), pool};
+    return filterKruskal.run(edges, 0, edges.size());
+}
+
+namespace {
+
+void checkClusterCount(std::size_t k, std::size_t nvertices)
+{
+    if (k == 0 || k > nvertices)
+        throw AlgoException{fmt::format(AlgoException::GraphClusterCount, k, nvertices)};
+}
+
+// takes the edges out of a heap, cheapest first, until k sets are left; the next edge between
+// two sets is the spacing
+int mergeClusters(std::vector<CsrEdge>& edges, std::size_t k, UnionFind& clusters)
+{
+    auto isHeavier = [](const CsrEdge& lhs, const CsrEdge& rhs) { return lhs.value > rhs.value; };
+    std::make_heap(edges.begin(), edges.end(), isHeavier);
+
+    for (auto last = edges.end(); last != edges.begin(); --last) {
+        std::pop_heap(edges.begin(), last, isHeavier);
+        const CsrEdge& e = *(last - 1);
+        if (clusters.isSame(e.u, e.v))
+            continue;
+        if (clusters.nsets() == k)
+            return e.value;
+        clusters.unite(e.u, e.v);
+    }
+    return KruskalMinSpanningGraph::kNoSpacing;
+}
+
+std::vector<CsrEdge> csrEdges(const CsrGraph& graph)
+{
+    std::vector<CsrEdge> edges;
+    edges.reserve(graph.type() == GraphType::Undirected ? graph.nedges() / 2 : graph.nedges());
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            vertexid_t v = graph.target(e);
+            if ((graph.type() == GraphType::Directed || u < v) && u != v)
+                edges.push_back(CsrEdge{u, v, graph.weight(e)});
+        }
+    }
+    return edges;
+}
+
+} // anonymous
+
+Clustering KruskalMinSpanningGraph::cluster(std::size_t k)
+{
+    checkClusterCount(k, m_vertices.size());
+
+    std::vector<CsrEdge> edges;
+    edges.reserve(m_edges.size());
+    for (auto e : m_edges)
+        edges.push_back(CsrEdge{e->u()->id(), e->v()->id(), e->cost()});
+
+    UnionFind clusters{m_vertices.size()};
+    int spacing = mergeClusters(edges, k, clusters);
+    return Clustering{clusters.labels(), spacing};
+}
+
+int KruskalMinSpanningGraph::maxSpacing(std::size_t k)
+{
+    return this->cluster(k).spacing;
+}
+
+Clustering KruskalMinSpanningGraph::cluster(const CsrGraph& graph, std::size_t k)
+{
+    checkClusterCount(k, graph.nvertices());
+
+    std::vector<CsrEdge> edges = csrEdges(graph);
+    UnionFind clusters{graph.nvertices()};
+    int spacing = mergeClusters(edges, k, clusters);
+    return Clustering{clusters.labels(), spacing};
+}
+
+int KruskalMinSpanningGraph::maxSpacing(const CsrGraph& graph, std::size_t k)
+{
+    checkClusterCount(k, graph.nvertices());
+
+    std::vector<CsrEdge> edges = csrEdges(graph);
+    UnionFind clusters{graph.nvertices()};
+    return mergeClusters(edges, k, clusters);
+}
+
+Clustering KruskalMinSpanningGraph::clusterHamming(const std::vector<std::uint32_t>& codes,
+                                                   unsigned int nbits, std::size_t k)
+{
+    if (nbits == 0 || nbits > 32)
+        throw AlgoException{fmt::format(AlgoException::InvalidIndex, "the code bits", 1, 32)};
+    checkClusterCount(k, codes.size());
+
+    // the first point of every code, a duplicate is united with it at distance 0
+    std::unordered_map<std::uint32_t, vertexid_t> points;
+    points.reserve(codes.size());
+    for (vertexid_t p = 0; p < codes.size(); ++p)
+        points.emplace(codes[p], p);
+
+    UnionFind clusters{codes.size()};
+    const std::uint64_t end = std::uint64_t{1} << nbits;
+
+    for (unsigned int distance = 0; distance <= nbits; ++distance) {
+        // every mask of nbits with distance bits set, in increasing order
+        for (std::uint64_t mask = (std::uint64_t{1} << distance) - 1; mask < end;) {
+            for (vertexid_t p = 0; p < codes.size(); ++p) {
+                auto it = points.find(codes[p] ^ static_cast<std::uint32_t>(mask));
+                if (it == points.end() || clusters.isSame(p, it->second))
+                    continue;
+                if (clusters.nsets() == k)
+                    return Clustering{clusters.labels(), static_cast<int>(distance)};
+                clusters.unite(p, it->second);
+            }
+
+            if (mask == 0)
+                break;
+            std::uint64_t lowest = mask & (~mask + 1);
+            std::uint64_t ripple = mask + lowest;
+            mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+        }
+    }
+    return Clustering{clusters.labels(), kNoSpacing};
+}
+
+namespace {
+
+using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+// an edge as spilled to the run files
+struct EdgeRecord
+{
+    int cost;
+    vertexid_t u;
+    vertexid_t v;
+};
+
+/**
+ * Reads the edge list file sequentially through a buffer, the numbers are parsed straight out
+ * of it. The vertices come back counted from 0.
+ */
+class EdgeListReader
+{
+public:
+    EdgeListReader(const std::string& filePath, std::size_t bufferSize)
+        : m_filePath{filePath}
+        , m_file{std::fopen(filePath.c_str(), "rb"), &std::fclose}
+        , m_buffer(bufferSize)
+    {
+        if (!m_file)
+            throw AlgoException{fmt::format(AlgoException::FileOpenRead, filePath)};
+    }
+
+    // "nvertices [nedges]", the number of edges is not needed
+    std::size_t readHeader()
+    {
+        long nvertices = 0;
+        long nedges = 0;
+        // the vertices must fit vertex ids, or the ids above would wrap onto others
+        if (!this->readNumber(nvertices, true) || nvertices < 0
+                || static_cast<unsigned long>(nvertices) > std::numeric_limits<vertexid_t>::max())
+            this->throwBadFormat(fmt::format("number of vertices in [0, {}]",
+                                             std::numeric_limits<vertexid_t>::max()));
+        this->readNumber(nedges, false);
+        this->expectLineEnd("nvertices [nedges]");
+
+        m_nvertices = static_cast<std::size_t>(nvertices);
+        return m_nvertices;
+    }
+
+    // false at the end of the file
+    bool readEdge(EdgeRecord& edge)
+    {
+        long u = 0;
+        long v = 0;
+        long cost = 0;
+        if (!this->readNumber(u, true)) {
+            if (this->peek() != EOF)
+                this->throwBadFormat("u v cost");
+            return false;
+        }
+        if (!this->readNumber(v, false) || !this->readNumber(cost, false))
+            this->throwBadFormat("u v cost");
+        this->expectLineEnd("u v cost");
+
+        for (long w : {u, v}) {
+            if (w < 1 || static_cast<std::size_t>(w) > m_nvertices)
+                this->throwBadFormat(fmt::format("vertex in [1, {}]", m_nvertices));
+        }
+        if (cost < std::numeric_limits<int>::min() || cost > std::numeric_limits<int>::max()) {
+            this->throwBadFormat(fmt::format("cost in [{}, {}]", std::numeric_limits<int>::min(),
+                                             std::numeric_limits<int>::max()));
+        }
+        edge = EdgeRecord{static_cast<int>(cost), static_cast<vertexid_t>(u - 1),
+                          static_cast<vertexid_t>(v - 1)};
+        return true;
+    }
+
+private:
+    int peek()
+    {
+        if (m_pos == m_end) {
+            std::size_t n = std::fread(m_buffer.data(), 1, m_buffer.size(), m_file.get());
+            if (n < m_buffer.size() && std::ferror(m_file.get())) {
+                throw AlgoException{fmt::format(AlgoException::FileRead, m_filePath,
+                                                std::strerror(errno))};
+            }
+            m_pos = m_buffer.data();
+            m_end = m_pos + n;
+            if (n == 0)
+                return EOF;
+        }
+        return static_cast<unsigned char>(*m_pos);
+    }
+
+    // skips the blanks, also the line ends if newLine; false if no number comes first
+    bool readNumber(long& value, bool newLine)
+    {
+        int c = this->peek();
+        while (c == ' ' || c == '\t' || c == '\r' || (newLine && c == '\n')) {
+            m_line += c == '\n';
+            ++m_pos;
+            c = this->peek();
+        }
+
+        bool negative = c == '-';
+        if (negative) {
+            ++m_pos;
+            c = this->peek();
+        }
+        if (c < '0' || c > '9') {
+            if (negative)
+                this->throwBadFormat("number");
+            return false;
+        }
+
+        value = 0;
+        for (; c >= '0' && c <= '9'; c = this->peek()) {
+            if (value > (std::numeric_limits<long>::max() - (c - '0')) / 10)
+                this->throwBadFormat("number in the long range");
+            value = value * 10 + (c - '0');
+            ++m_pos;
+        }
+        if (negative)
+            value = -value;
+        return true;
+    }
+
+    void expectLineEnd(const char* expected)
+    {
+        int c = this->peek();
+        while (c == ' ' || c == '\t' || c == '\r') {
+            ++m_pos;
+            c = this->peek();
+        }
+        if (c != '\n' && c != EOF)
+            this->throwBadFormat(expected);
+    }
+
+    [[noreturn]] void throwBadFormat(const std::string& expected) const
+    {
+        throw AlgoException{fmt::format(AlgoException::GraphBadFormat, expected,
+                                        fmt::format("line {} of '{}'", m_line, m_filePath))};
+    }
+
+    std::string m_filePath;
+    File m_file;
+    std::vector<char> m_buffer;
+    char* m_pos{nullptr};
+    char* m_end{nullptr};
+    std::size_t m_line{1};
+    std::size_t m_nvertices{0};
+};
+
+// the sorted runs of a pass, one after another in one unnamed temporary file, so a pass never
+// keeps more than a file open however many runs it has
+class SpillFile
+{
+public:
+    explicit SpillFile(const std::string& directory)
+        : m_file{nullptr, &std::fclose}
+    {
+        std::string path = directory + "/psa-kruskal-XXXXXX";
+        int fd = ::mkstemp(&path[0]);
+        if (fd < 0)
+            throw AlgoException{fmt::format(AlgoException::FileOpenWrite, path)};
+        ::unlink(path.c_str());
+
+        m_file.reset(::fdopen(fd, "w+b"));
+        if (!m_file) {
+            ::close(fd);
+            throw AlgoException{fmt::format(AlgoException::FileOpenWrite, path)};
+        }
+    }
+
+    std::size_t nruns() const { return m_runs.size(); }
+
+    // appends to the last run, see endRun()
+    void write(const EdgeRecord* records, std::size_t nrecords)
+    {
+        if (std::fwrite(records, sizeof(EdgeRecord), nrecords, m_file.get()) != nrecords)
+            this->throwWrite();
+        m_nrecords += nrecords;
+    }
+
+    void endRun()
+    {
+        std::uint64_t first = m_runs.empty() ? 0 : m_runs.back().first + m_runs.back().nrecords;
+        m_runs.push_back(Run{first, m_nrecords - first});
+    }
+
+    // all written out, a full disk shows here rather than in write()
+    void flush()
+    {
+        if (std::fflush(m_file.get()) != 0)
+            this->throwWrite();
+    }
+
+    // the records [first, first + nrecords) of run r from offset on, the count read
+    std::size_t read(std::size_t r, std::uint64_t offset, EdgeRecord* records,
+                     std::size_t nrecords)
+    {
+        const Run& run = m_runs[r];
+        nrecords = static_cast<std::size_t>(std::min<std::uint64_t>(nrecords,
+                                                                    run.nrecords - offset));
+        if (nrecords == 0)
+            return 0;
+
+        auto position = static_cast<off_t>((run.first + offset) * sizeof(EdgeRecord));
+        if (::fseeko(m_file.get(), position, SEEK_SET) != 0
+                || std::fread(records, sizeof(EdgeRecord), nrecords, m_file.get()) != nrecords) {
+            // a short read is an error too, the run is known to be this long
+            throw AlgoException{fmt::format(AlgoException::FileRead, "temporary run file",
+                                            std::ferror(m_file.get()) ? std::strerror(errno)
+                                                                      : "truncated")};
+        }
+        return nrecords;
+    }
+
+private:
+    struct Run
+    {
+        std::uint64_t first;
+        std::uint64_t nrecords;
+    };
+
+    [[noreturn]] void throwWrite() const
+    {
+        throw AlgoException{fmt::format(AlgoException::FileWrite, "temporary run file",
+                                        std::strerror(errno))};
+    }
+
+    File m_file;
+    std::vector<Run> m_runs;
+    std::uint64_t m_nrecords{0};
+};
+
+class RunReader
 {
-    if (v->leader() == v || v->leader()->leader() == v->leader())
-        return v->leader();
+public:
+    RunReader(SpillFile& spill, std::size_t run, std::size_t nrecords)
+        : m_spill{spill}
+        , m_run{run}
+        , m_buffer(nrecords)
+    {
+        this->refill();
+    }
 
-    std::forward_list<KruskalMinSpanningGraphVertex*> vertices;
-    while (v->leader() != v) {
-        vertices.push_front(v);
-        v = v->leader();
+    bool isEmpty() const { return m_pos == m_count; }
+    const EdgeRecord& head() const { return m_buffer[m_pos]; }
+
+    void pop()
+    {
+        if (++m_pos == m_count)
+            this->refill();
+    }
+
+private:
+    void refill()
+    {
+        m_count = m_spill.read(m_run, m_offset, m_buffer.data(), m_buffer.size());
+        m_offset += m_count;
+        m_pos = 0;
     }
 
-    vertices.pop_front();
-    for (auto u : vertices)
-        u->setLeader(v);
+    SpillFile& m_spill;
+    std::size_t m_run;
+    std::vector<EdgeRecord> m_buffer;
+    std::uint64_t m_offset{0};
+    std::size_t m_pos{0};
+    std::size_t m_count{0};
+};
+
+struct RunHead
+{
+    int cost;
+    std::size_t run;
+};
+
+struct RunHeadLess
+{
+    bool operator()(const RunHead& lhs, const RunHead& rhs) const { return lhs.cost < rhs.cost; }
+};
+
+// merges the runs into func(edge) cheapest first, until func returns false
+template<typename Func>
+void mergeRuns(SpillFile& spill, std::size_t first, std::size_t last, std::size_t bufferRecords,
+               Func func)
+{
+    std::vector<RunReader> readers;
+    readers.reserve(last - first);
+    MinHeap<RunHead, RunHeadLess> heads;
+    for (std::size_t r = first; r < last; ++r) {
+        readers.emplace_back(spill, r, bufferRecords);
+        if (!readers.back().isEmpty())
+            heads.push(RunHead{readers.back().head().cost, readers.size() - 1});
+    }
 
-    return v;
+    while (!heads.isEmpty()) {
+        std::size_t r = heads.pop().run;
+        RunReader& reader = readers[r];
+        if (!func(reader.head()))
+            return;
+        reader.pop();
+        if (!reader.isEmpty())
+            heads.push(RunHead{reader.head().cost, r});
+    }
 }
 
-void KruskalMinSpanningGraph::unionLeaders(KruskalMinSpanningGraphVertex* u,
-                                           KruskalMinSpanningGraphVertex* v)
+} // anonymous
+
+/**
+ * The runs are merged fanIn at a time, each run and the output getting an equal share of the
+ * budget, till the last pass can merge them all into the union-find. Every pass writes its runs
+ * to a new spill file and drops the one it read.
+ */
+long KruskalMinSpanningGraph::findMstExternal(const std::string& edgeListPath,
+                                              std::size_t memoryBudget,
+                                              const std::string& tempDirectory)
 {
-    if (u->rank() > v->rank())
-        v->setLeader(u);
-    else if (u->rank() < v->rank())
-        u->setLeader(v);
-    else {
-        u->setRank(u->rank() + 1);
-        v->setLeader(u);
+    memoryBudget = std::max(memoryBudget, kMinMemoryBudget);
+    const std::size_t readBufferSize = std::min(memoryBudget / 8, kIoBufferSize);
+    auto isCheaper = [](const EdgeRecord& lhs, const EdgeRecord& rhs) {
+        return lhs.cost < rhs.cost;
+    };
+
+    // the reader and its buffer are gone before the merge takes the whole budget
+    std::size_t nvertices = 0;
+    std::vector<EdgeRecord> chunk;
+    std::unique_ptr<SpillFile> spill;
+    {
+        EdgeListReader reader{edgeListPath, readBufferSize};
+        nvertices = reader.readHeader();
+        chunk.reserve((memoryBudget - readBufferSize) / sizeof(EdgeRecord));
+
+        EdgeRecord edge;
+        while (reader.readEdge(edge)) {
+            chunk.push_back(edge);
+            if (chunk.size() == chunk.capacity()) {
+                std::sort(chunk.begin(), chunk.end(), isCheaper);
+                if (!spill)
+                    spill.reset(new SpillFile{tempDirectory});
+                spill->write(chunk.data(), chunk.size());
+                spill->endRun();
+                chunk.clear();
+            }
+        }
+    }
+
+    long cost = 0;
+    UnionFind leaders{nvertices};
+    auto unite = [&cost, &leaders](const EdgeRecord& e) {
+        if (leaders.unite(e.u, e.v))
+            cost += e.cost;
+        return leaders.nsets() > 1;
+    };
+
+    std::sort(chunk.begin(), chunk.end(), isCheaper);
+    if (!spill) {
+        // all of it fit in memory
+        for (auto& e : chunk) {
+            if (!unite(e))
+                break;
+        }
+        return cost;
+    }
+    if (!chunk.empty()) {
+        spill->write(chunk.data(), chunk.size());
+        spill->endRun();
+    }
+    std::vector<EdgeRecord>{}.swap(chunk);
+    spill->flush();
+
+    const std::size_t fanIn = std::max<std::size_t>(memoryBudget / kIoBufferSize, 2);
+    const std::size_t bufferRecords = memoryBudget / (fanIn + 1) / sizeof(EdgeRecord);
+
+    while (spill->nruns() > fanIn) {
+        std::unique_ptr<SpillFile> merged{new SpillFile{tempDirectory}};
+        std::vector<EdgeRecord> output;
+        output.reserve(bufferRecords);
+        for (std::size_t first = 0; first < spill->nruns(); first += fanIn) {
+            std::size_t last = std::min(first + fanIn, spill->nruns());
+            mergeRuns(*spill, first, last, bufferRecords, [&](const EdgeRecord& e) {
+                output.push_back(e);
+                if (output.size() == bufferRecords) {
+                    merged->write(output.data(), output.size());
+                    output.clear();
+                }
+                return true;
+            });
+            merged->write(output.data(), output.size());
+            merged->endRun();
+            output.clear();
+        }
+        merged->flush();
+        spill.swap(merged);
     }
+
+    mergeRuns(*spill, 0, spill->nruns(), bufferRecords, unite);
+    return cost;
 }
 
 #ifdef UNIT_TEST
 
+namespace {
+
+// k clusters, spacing is the cheapest edge between two clusters, all the cheaper edges inside one
+void expectClusters(std::size_t k, const std::vector<CsrEdge>& edges, const Clustering& clusters)
+{
+    std::set<unsigned int> labels{clusters.labels.begin(), clusters.labels.end()};
+    EXPECT_EQ(k, labels.size());
+
+    int spacing = KruskalMinSpanningGraph::kNoSpacing;
+    for (auto& e : edges) {
+        if (clusters.labels[e.u] != clusters.labels[e.v])
+            spacing = std::min(spacing, e.value);
+    }
+    EXPECT_EQ(spacing, clusters.spacing) << k;
+}
+
+} // anonymous
+
 TEST(KruskalMinSpanningGraphTest, Mst)
 {
     const std::string filename{"MinSpanningGraphAdjList.txt"};
@@ -95,6 +797,157 @@ TEST(KruskalMinSpanningGraphTest, Mst)
     EXPECT_EQ(expected, actual);
 }
 
+TEST(KruskalMinSpanningGraphTest, CsrMst)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    EXPECT_EQ(39, KruskalMinSpanningGraph::findMst(graph));
+}
+
+TEST(KruskalMinSpanningGraphTest, FilterKruskal)
+{
+    // big enough to split a few times, negative costs and many ties
+    const std::size_t nvertices = 20000;
+    CsrGraph graph = randomCsrGraph(GraphType::Undirected, nvertices, 20 * nvertices, 22,
+                                    {-5000, 5000});
+
+    long expected = KruskalMinSpanningGraph::findMst(graph);
+    for (std::size_t nthreads : {1, 4}) {
+        ThreadPool pool{nthreads};
+        EXPECT_EQ(expected, KruskalMinSpanningGraph::findMst(graph, pool));
+    }
+
+    ThreadPool pool{2};
+    CsrGraph small = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    EXPECT_EQ(39, KruskalMinSpanningGraph::findMst(small, pool));
+}
+
+TEST(KruskalMinSpanningGraphTest, Cluster)
+{
+    const std::string filename{"MinSpanningGraphAdjList.txt"};
+    std::ifstream stream{filename};
+    if (!stream)
+        throw AlgoException{fmt::format(AlgoException::FileOpenRead, filename)};
+
+    KruskalMinSpanningGraph graph;
+    graph.readAdjList(stream);
+    CsrGraph csrGraph = CsrGraph::fromAdjList(filename);
+    std::vector<CsrEdge> edges = csrEdges(csrGraph);
+
+    for (std::size_t k = 1; k <= graph.nvertices(); ++k) {
+        Clustering clusters = graph.cluster(k);
+        expectClusters(k, edges, clusters);
+        EXPECT_EQ(clusters.spacing, graph.maxSpacing(k));
+        EXPECT_EQ(clusters.labels, KruskalMinSpanningGraph::cluster(csrGraph, k).labels);
+        EXPECT_EQ(clusters.spacing, KruskalMinSpanningGraph::maxSpacing(csrGraph, k));
+    }
+    EXPECT_EQ(KruskalMinSpanningGraph::kNoSpacing, graph.maxSpacing(1));
+    EXPECT_THROW(graph.cluster(0), AlgoException);
+    EXPECT_THROW(graph.cluster(graph.nvertices() + 1), AlgoException);
+}
+
+TEST(KruskalMinSpanningGraphTest, ClusterRandomGraph)
+{
+    const std::size_t nvertices = 3000;
+    std::vector<CsrEdge> edges = randomCsrEdges(nvertices, 4 * nvertices, 24, {-100, 100});
+    CsrGraph graph{GraphType::Undirected, nvertices, edges};
+
+    // the graph has a few isolated vertices, so never fewer clusters than its components
+    const std::size_t ncomponents = UnionFind::connect(graph).nsets();
+    for (std::size_t k : {std::size_t{1}, ncomponents, ncomponents + 10, std::size_t{1000}}) {
+        Clustering clusters = KruskalMinSpanningGraph::cluster(graph, k);
+        expectClusters(std::max(k, ncomponents), edges, clusters);
+    }
+}
+
+TEST(KruskalMinSpanningGraphTest, ClusterHamming)
+{
+    std::mt19937 random{24};
+    const unsigned int nbits = 12;
+    std::uniform_int_distribution<std::uint32_t> values{0, (1u << nbits) - 1};
+
+    std::vector<std::uint32_t> codes(400);
+    for (auto& code : codes)
+        code = values(random);
+    codes[7] = codes[3]; // a duplicate
+
+    // every pair, as the edges clusterHamming never builds
+    std::vector<CsrEdge> edges;
+    for (vertexid_t p = 0; p < codes.size(); ++p) {
+        for (vertexid_t q = p + 1; q < codes.size(); ++q) {
+            std::uint32_t bits = codes[p] ^ codes[q];
+            int distance = 0;
+            for (; bits; bits &= bits - 1)
+                ++distance;
+            edges.push_back(CsrEdge{p, q, distance});
+        }
+    }
+
+    for (std::size_t k : {1, 4, 50, 300, 399, 400}) {
+        Clustering clusters = KruskalMinSpanningGraph::clusterHamming(codes, nbits, k);
+        if (k == 400) {
+            // the duplicate is two clusters at distance 0
+            EXPECT_EQ(0, clusters.spacing);
+            continue;
+        }
+        expectClusters(k, edges, clusters);
+    }
+    EXPECT_THROW(KruskalMinSpanningGraph::clusterHamming(codes, 33, 1), AlgoException);
+}
+
+TEST(KruskalMinSpanningGraphTest, ExternalMst)
+{
+    const std::string filename{"KruskalExternalTest.txt"};
+    const std::size_t nvertices = 3000;
+
+    // connected, so the merge stops early, then too sparse for that
+    for (std::size_t nedges : {10 * nvertices, nvertices}) {
+        std::vector<CsrEdge> edges = randomCsrEdges(nvertices, nedges, 25, {-1000, 1000});
+
+        {
+            std::ofstream stream{filename};
+            stream << nvertices << " " << nedges << "\n";
+            for (auto& e : edges)
+                stream << e.u + 1 << " " << e.v + 1 << " " << e.value << "\n";
+        }
+
+        long expected = KruskalMinSpanningGraph::findMst(CsrGraph{GraphType::Directed, nvertices,
+                                                                  edges});
+        // many runs merged in a few passes, a few runs, all in memory
+        for (std::size_t budget : {std::size_t{0}, std::size_t{1} << 16, std::size_t{1} << 24}) {
+            EXPECT_EQ(expected, KruskalMinSpanningGraph::findMstExternal(filename, budget))
+                    << budget;
+        }
+
+        // the runs share a file, so more of them than the open file limit still merge
+        rlimit limit;
+        ASSERT_EQ(0, ::getrlimit(RLIMIT_NOFILE, &limit));
+        rlimit low = limit;
+        low.rlim_cur = std::min<rlim_t>(limit.rlim_cur, 16);
+        ASSERT_EQ(0, ::setrlimit(RLIMIT_NOFILE, &low));
+        long actual = KruskalMinSpanningGraph::findMstExternal(filename, 0);
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        EXPECT_EQ(expected, actual);
+    }
+    std::remove(filename.c_str());
+}
+
+TEST(KruskalMinSpanningGraphTest, ExternalMstBadFormat)
+{
+    const std::string filename{"KruskalExternalTest.txt"};
+    for (const char* text : {"3\n1 2 5\n2 3\n", "3\n1 4 5\n", "3 2 1\n", "3\n1 2 x\n",
+                             "3\n1 2 3000000000\n", "3\n1 2 -2147483649\n",
+                             "99999999999999999999\n1 2 5\n", "4294967296\n1 2 5\n"}) {
+        {
+            std::ofstream stream{filename};
+            stream << text;
+        }
+        EXPECT_THROW(KruskalMinSpanningGraph::findMstExternal(filename, 0), AlgoException) << text;
+    }
+    std::remove(filename.c_str());
+
+    EXPECT_THROW(KruskalMinSpanningGraph::findMstExternal(filename, 0), AlgoException);
+}
+
 TEST(KruskalMinSpanningGraphTest, AlgoClassMst)
 {
     const std::string filename{"AlgoClassMinSpanningGraphAdjList.txt"};
@@ -0,0 +1,218 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+
+#ifdef UNIT_TEST
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+MappedFile::MappedFile(const std::string& filePath)
+    : m_filePath{filePath}
+{
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw AlgoException{fmt::format(AlgoException::FileOpenRead, filePath)};
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        int error = errno;
+        ::close(fd);
+        throw AlgoException{fmt::format(AlgoException::FileMap, filePath, std::strerror(error))};
+    }
+
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size > 0) { // mmap() does not accept zero length, leave empty file unmapped
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw AlgoException{fmt::format(AlgoException::FileMap, filePath, std::strerror(error))};
+        }
+        m_data = static_cast<char*>(addr);
+        ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd); // mapping stays valid after close
+}
+
+/**
+ * @brief MappedFile::MappedFile creates filePath.tmp and maps it for writing, commit() moves it
+ * over filePath. Until then filePath keeps its old contents, so the data being written may come
+ * from a mapping of filePath itself and a crash leaves no torn file behind.
+ */
+MappedFile::MappedFile(const std::string& filePath, std::size_t size)
+    : m_filePath{filePath}
+    , m_tmpPath{filePath + ".tmp"}
+{
+    m_fd = ::open(m_tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+        throw AlgoException{fmt::format(AlgoException::FileOpenWrite, m_tmpPath)};
+
+    if (size > 0) {
+        // reserve the blocks now, a store into a hole of a full disk would raise SIGBUS
+        int error = ::posix_fallocate(m_fd, 0, static_cast<off_t>(size));
+        if (error != 0) {
+            this->discard();
+            throw AlgoException{fmt::format(AlgoException::FileWrite, m_tmpPath,
+                                            std::strerror(error))};
+        }
+
+        void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (addr == MAP_FAILED) {
+            error = errno;
+            this->discard();
+            throw AlgoException{fmt::format(AlgoException::FileMap, m_tmpPath,
+                                            std::strerror(error))};
+        }
+        m_data = static_cast<char*>(addr);
+        m_size = size;
+    }
+}
+
+MappedFile::MappedFile(MappedFile&& rhs)
+    : m_filePath{std::move(rhs.m_filePath)}
+    , m_tmpPath{std::move(rhs.m_tmpPath)}
+    , m_data{rhs.m_data}
+    , m_size{rhs.m_size}
+    , m_fd{rhs.m_fd}
+{
+    rhs.m_data = nullptr;
+    rhs.m_size = 0;
+    rhs.m_fd = -1;
+}
+
+MappedFile::~MappedFile()
+{
+    this->unmap();
+    this->discard();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs)
+{
+    if (&rhs != this) {
+        this->unmap();
+        this->discard();
+
+        m_filePath = std::move(rhs.m_filePath);
+        m_tmpPath = std::move(rhs.m_tmpPath);
+        m_data = rhs.m_data;
+        m_size = rhs.m_size;
+        m_fd = rhs.m_fd;
+
+        rhs.m_data = nullptr;
+        rhs.m_size = 0;
+        rhs.m_fd = -1;
+    }
+    return *this;
+}
+
+/**
+ * @brief MappedFile::commit writes the pages of a file created for writing back to disk, waits
+ * for it and renames the file over filePath, throws if any step fails. Unmapping alone doesn't
+ * report write back errors. The mapping stays valid, now as the contents of filePath.
+ */
+void MappedFile::commit()
+{
+    if (m_fd < 0)
+        return;
+
+    if ((m_data && ::msync(m_data, m_size, MS_SYNC) < 0) || ::fsync(m_fd) < 0
+            || ::rename(m_tmpPath.c_str(), m_filePath.c_str()) < 0) {
+        int error = errno;
+        this->unmap();
+        this->discard();
+        throw AlgoException{fmt::format(AlgoException::FileWrite, m_filePath,
+                                        std::strerror(error))};
+    }
+
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data)
+        ::munmap(m_data, m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+// drops a file created for writing that was not committed
+void MappedFile::discard()
+{
+    if (m_fd < 0)
+        return;
+
+    ::close(m_fd);
+    ::unlink(m_tmpPath.c_str());
+    m_fd = -1;
+}
+
+#ifdef UNIT_TEST
+
+TEST(MappedFileTest, Read)
+{
+    MappedFile file{"DijkstraAdjList.txt"};
+    ASSERT_GT(file.size(), 9u);
+    EXPECT_EQ("directed\n", std::string(file.data(), 9));
+
+    bool passed = false;
+    try {
+        MappedFile missing{"NoSuchFile.txt"};
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "Mapping a missing file should throw an exception!";
+}
+
+TEST(MappedFileTest, Write)
+{
+    const std::string filename{"MappedFileTest.bin"};
+    {
+        MappedFile file{filename, 6};
+        std::memcpy(file.data(), "abcdef", 6);
+        file.commit();
+    }
+
+    {
+        MappedFile file{filename};
+        EXPECT_EQ("abcdef", std::string(file.data(), file.size()));
+    }
+
+    // a file not committed leaves the old one in place and nothing else behind
+    {
+        MappedFile file{filename, 3};
+        std::memcpy(file.data(), "xyz", 3);
+    }
+    {
+        MappedFile file{filename};
+        EXPECT_EQ("abcdef", std::string(file.data(), file.size()));
+        EXPECT_NE(0, ::access((filename + ".tmp").c_str(), F_OK));
+    }
+
+    std::remove(filename.c_str());
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "ObjectArena.h"
+
+#ifdef UNIT_TEST
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+#ifdef UNIT_TEST
+
+namespace {
+
+struct Counted
+{
+    Counted(int v, int& count) : value{v}, alive{count} { ++alive; }
+    ~Counted() { --alive; }
+
+    int value;
+    int& alive;
+};
+
+} // anonymous
+
+TEST(ObjectArenaTest, CreateRewind)
+{
+    int alive = 0;
+    {
+        ObjectArena<Counted> arena;
+        arena.reserve(10);
+
+        std::vector<Counted*> objects;
+        for (int i = 0; i < 3000; ++i)
+            objects.push_back(arena.create(i, alive));
+        EXPECT_EQ(3000u, arena.size());
+        EXPECT_EQ(3000, alive);
+        EXPECT_EQ(2999, objects.back()->value);
+
+        arena.rewind(5);
+        EXPECT_EQ(5u, arena.size());
+        EXPECT_EQ(5, alive);
+        EXPECT_EQ(4, objects[4]->value);
+
+        Counted* c = arena.create(42, alive);
+        EXPECT_EQ(objects[5], c); // memory is reused
+        EXPECT_EQ(6, alive);
+    }
+    EXPECT_EQ(0, alive);
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
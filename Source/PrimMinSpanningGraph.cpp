@@ -5,9 +5,6 @@
 
 #include "PrimMinSpanningGraph.h"
 
-#include <unordered_map>
-#include <utility>
-
 #ifdef UNIT_TEST
 #include <fstream>
 
@@ -15,51 +12,35 @@
 #endif
 
 #include "AlgoBase.h"
-#include "MinHeap.h"
+#include "CsrGraph.h"
+#include "IndexedMinHeap.h"
 
 namespace psa {
 
-// LessThan function type, for less than compare function on PrimMinSpanningGraphVertex
-using LessThan = bool(*)(PrimMinSpanningGraphVertex*, PrimMinSpanningGraphVertex*);
-
-PrimMinSpanningGraph::~PrimMinSpanningGraph()
-{
-    for (auto edge : m_edges)
-        delete edge;
-
-    for (auto vertex : m_vertices)
-        delete vertex;
-}
-
 long PrimMinSpanningGraph::findMst()
 {
     PrimMinSpanningGraphVertex* v = this->vertex(0); // some arbitrary vertex
     v->setCost(0);
 
     long cost = 0;
-    std::unordered_map<vertexid_t, std::size_t> heapIndexMap;
 
-    // less than lambda
-    auto lessThan = [](PrimMinSpanningGraphVertex* lhs, PrimMinSpanningGraphVertex* rhs) -> bool
-        { return lhs->cost() < rhs->cost(); };
+    IndexedMinHeap<int> verticesToProcess{m_vertices.size()};
+    verticesToProcess.push(v->id(), v->cost());
 
-    MinHeap<PrimMinSpanningGraphVertex*, LessThan, HeapIndex<PrimMinSpanningGraphVertex>>
-        verticesToProcess{m_vertices, lessThan, HeapIndex<PrimMinSpanningGraphVertex>{heapIndexMap}};
-
-    std::vector<PrimMinSpanningGraphVertex*> processedVertices{m_vertices.size()}; // fill with nullptr
+    std::vector<bool> processed(m_vertices.size(), false);
 
     while (!verticesToProcess.isEmpty()) {
-        v = verticesToProcess.pop();
+        v = m_vertices[verticesToProcess.pop().id];
 
-        processedVertices[v->id()] = v;
+        processed[v->id()] = true;
         cost += v->cost();
 
         for (auto e : v->edges()) {
             PrimMinSpanningGraphVertex* w = e->v();
-            if (!processedVertices[w->id()]) {
+            if (!processed[w->id()]) {
                 if (e->cost() < w->cost()) {
                     w->setCost(e->cost());
-                    verticesToProcess.siftup(heapIndexMap[w->id()]);
+                    verticesToProcess.pushOrDecrease(w->id(), w->cost());
                 }
             }
         }
@@ -68,6 +49,50 @@ long PrimMinSpanningGraph::findMst()
     return cost;
 }
 
+/**
+ * @brief PrimMinSpanningGraph::findMst computes the minimum spanning tree cost on CSR topology,
+ * starting from vertex 0. The graph itself is not modified.
+ */
+long PrimMinSpanningGraph::findMst(const CsrGraph& graph)
+{
+    BasicSearchContext<int> context;
+    return PrimMinSpanningGraph::findMst(graph, context);
+}
+
+/**
+ * Same as findMst(graph), the cheapest edge cost seen for every vertex and the tree parents
+ * are kept in the context.
+ */
+long PrimMinSpanningGraph::findMst(const CsrGraph& graph, BasicSearchContext<int>& context)
+{
+    context.reset(graph.nvertices());
+    if (graph.nvertices() == 0)
+        return 0;
+
+    long cost = 0;
+
+    IndexedMinHeap<int>& verticesToProcess = context.heap();
+
+    context.reach(0, 0, BasicSearchContext<int>::kNoVertex);
+    verticesToProcess.push(0, 0);
+
+    while (!verticesToProcess.isEmpty()) {
+        vertexid_t v = verticesToProcess.pop().id;
+        context.settle(v);
+        cost += context.distance(v);
+
+        for (edgeid_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+            vertexid_t w = graph.target(e);
+            if (!context.isSettled(w) && graph.weight(e) < context.distance(w)) {
+                context.reach(w, graph.weight(e), v);
+                verticesToProcess.pushOrDecrease(w, graph.weight(e));
+            }
+        }
+    }
+
+    return cost;
+}
+
 #ifdef UNIT_TEST
 
 TEST(PrimMinSpanningGraphTest, Mst)
@@ -85,6 +110,18 @@ TEST(PrimMinSpanningGraphTest, Mst)
     EXPECT_EQ(expected, actual);
 }
 
+TEST(PrimMinSpanningGraphTest, CsrMst)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("MinSpanningGraphAdjList.txt");
+    EXPECT_EQ(39, PrimMinSpanningGraph::findMst(graph));
+
+    BasicSearchContext<int> context;
+    EXPECT_EQ(39, PrimMinSpanningGraph::findMst(graph, context));
+    EXPECT_EQ(39, PrimMinSpanningGraph::findMst(graph, context));
+    for (vertexid_t v = 1; v < graph.nvertices(); ++v)
+        EXPECT_NE(BasicSearchContext<int>::kNoVertex, context.parent(v));
+}
+
 TEST(PrimMinSpanningGraphTest, AlgoClassMst)
 {
     const std::string filename{"AlgoClassMinSpanningGraphAdjList.txt"};
@@ -48,7 +48,7 @@ int Queue::dequeue()
         throw AlgoException("There is no elements in the queue.");
 
     int retval = m_queue[m_istart];
-    m_istart = ++m_istart % m_capacity;
+    m_istart = (m_istart + 1) % m_capacity;
     --m_size;
     return retval;
 }
@@ -0,0 +1,52 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "RadixHeap.h"
+
+#ifdef UNIT_TEST
+#include <random>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+#ifdef UNIT_TEST
+
+TEST(RadixHeapTest, Monotone)
+{
+    std::mt19937 random{7};
+    std::uniform_int_distribution<unsigned int> lengths{0, 100000};
+
+    RadixHeap<unsigned int> heap;
+    heap.push(0, 0);
+
+    // like Dijkstra: every pop pushes a few keys not below the popped one
+    unsigned int last = 0;
+    std::size_t npopped = 0;
+    while (!heap.isEmpty()) {
+        auto entry = heap.pop();
+        EXPECT_LE(last, entry.key);
+        last = entry.key;
+
+        if (++npopped < 5000) {
+            for (int i = 0; i < 3; ++i)
+                heap.push(static_cast<vertexid_t>(npopped), entry.key + lengths(random));
+        }
+    }
+    EXPECT_EQ(0u, heap.size());
+
+    bool passed = false;
+    try {
+        heap.push(1, last - 1);
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "Key below the last popped key should throw!";
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -0,0 +1,200 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "ReachabilityIndex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "StronglyConnectedGraph.h"
+
+#ifdef UNIT_TEST
+#include <gtest/gtest.h>
+
+#include "BreadthFirstGraph.h"
+#endif
+
+namespace psa {
+
+const std::size_t ReachabilityIndex::kDefaultLabels;
+
+/**
+ * Every labeling is a depth first traversal from the sources of the DAG in random order, the
+ * children of a vertex taken from a random starting point. The DAG has no back edges, so all
+ * the children of a vertex are finished when it is, and its low is the least of theirs.
+ */
+ReachabilityIndex ReachabilityIndex::build(const CsrGraph& graph, std::size_t nlabels,
+                                           unsigned int seed)
+{
+    ReachabilityIndex index;
+    index.m_nlabels = nlabels;
+    index.m_components = StronglyConnectedGraph::tarjan(graph);
+    index.m_dag = StronglyConnectedGraph::condense(graph, index.m_components);
+
+    const CsrGraph& dag = index.m_dag;
+    const std::size_t ncomponents = dag.nvertices();
+
+    std::vector<vertexid_t> order = StronglyConnectedGraph::topologicalOrder(dag);
+    index.m_positions.resize(ncomponents);
+    for (vertexid_t i = 0; i < ncomponents; ++i)
+        index.m_positions[order[i]] = i;
+
+    std::vector<unsigned int> nincoming(ncomponents, 0);
+    for (edgeid_t e = 0; e < dag.nedges(); ++e)
+        ++nincoming[dag.target(e)];
+    std::vector<vertexid_t> sources;
+    for (vertexid_t c = 0; c < ncomponents; ++c) {
+        if (nincoming[c] == 0)
+            sources.push_back(c);
+    }
+
+    index.m_low.resize(ncomponents * nlabels);
+    index.m_rank.resize(ncomponents * nlabels);
+
+    struct Frame
+    {
+        vertexid_t c;
+        std::size_t nvisited; // children taken so far
+        std::size_t start;    // child to start from
+    };
+    std::vector<Frame> stack;
+    std::vector<std::uint8_t> visited(ncomponents);
+
+    for (std::size_t i = 0; i < nlabels; ++i) {
+        std::mt19937 random{seed + static_cast<unsigned int>(i)};
+        std::shuffle(sources.begin(), sources.end(), random);
+        std::fill(visited.begin(), visited.end(), 0);
+
+        auto open = [&dag, &stack, &visited, &random](vertexid_t c) {
+            visited[c] = 1;
+            std::size_t degree = dag.degree(c);
+            stack.push_back(Frame{c, 0, degree == 0 ? 0 : random() % degree});
+        };
+
+        unsigned int rank = 0;
+        for (vertexid_t source : sources) {
+            open(source);
+            while (!stack.empty()) {
+                Frame& frame = stack.back();
+                const vertexid_t c = frame.c;
+                const std::size_t degree = dag.degree(c);
+                if (frame.nvisited < degree) {
+                    std::size_t k = (frame.start + frame.nvisited++) % degree;
+                    vertexid_t child = dag.target(dag.edgeBegin(c) + k);
+                    if (!visited[child])
+                        open(child);
+                    continue;
+                }
+
+                unsigned int low = ++rank;
+                for (edgeid_t e = dag.edgeBegin(c); e < dag.edgeEnd(c); ++e)
+                    low = std::min(low, index.m_low[dag.target(e) * nlabels + i]);
+                index.m_low[c * nlabels + i] = low;
+                index.m_rank[c * nlabels + i] = rank;
+                stack.pop_back();
+            }
+        }
+    }
+
+    return index;
+}
+
+bool ReachabilityIndex::mayReach(unsigned int a, unsigned int b) const
+{
+    if (m_positions[a] > m_positions[b])
+        return false;
+
+    for (std::size_t i = 0; i < m_nlabels; ++i) {
+        if (m_low[b * m_nlabels + i] < m_low[a * m_nlabels + i]
+                || m_rank[b * m_nlabels + i] > m_rank[a * m_nlabels + i])
+            return false;
+    }
+    return true;
+}
+
+bool ReachabilityIndex::reaches(vertexid_t u, vertexid_t v) const
+{
+    SearchContext context;
+    return this->reaches(u, v, context);
+}
+
+/**
+ * Answered from the labels unless they nest, then a depth first search over the DAG that only
+ * goes into the components whose labels still nest around those of the target.
+ */
+bool ReachabilityIndex::reaches(vertexid_t u, vertexid_t v, SearchContext& context) const
+{
+    if (u >= m_components.size())
+        throw AlgoException{fmt::format("The given source vertex id, {} is not in the graph!", u)};
+    if (v >= m_components.size())
+        throw AlgoException{fmt::format("The given target vertex id, {} is not in the graph!", v)};
+
+    const unsigned int source = m_components[u];
+    const unsigned int target = m_components[v];
+    if (source == target)
+        return true;
+    if (!this->mayReach(source, target))
+        return false;
+
+    context.reset(m_dag.nvertices());
+    context.reach(source, 0, SearchContext::kNoVertex);
+    std::vector<vertexid_t>& stack = context.queue();
+    stack.push_back(source);
+
+    while (!stack.empty()) {
+        vertexid_t c = stack.back();
+        stack.pop_back();
+        for (edgeid_t e = m_dag.edgeBegin(c); e < m_dag.edgeEnd(c); ++e) {
+            vertexid_t child = m_dag.target(e);
+            if (child == target)
+                return true;
+            if (!context.isReached(child) && this->mayReach(child, target)) {
+                context.reach(child, 0, c);
+                stack.push_back(child);
+            }
+        }
+    }
+    return false;
+}
+
+#ifdef UNIT_TEST
+
+TEST(ReachabilityIndexTest, Reaches)
+{
+    // sparse enough to leave many small components and unreachable pairs
+    const std::size_t nvertices = 2000;
+    CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, nvertices + nvertices / 10, 20);
+
+    ReachabilityIndex index = ReachabilityIndex::build(graph);
+    EXPECT_EQ(nvertices, index.nvertices());
+    EXPECT_EQ(ReachabilityIndex::kDefaultLabels, index.nlabels());
+
+    // components in topological order: every edge goes forward
+    const CsrGraph& dag = index.dag();
+    for (vertexid_t c = 0; c < dag.nvertices(); ++c) {
+        for (edgeid_t e = dag.edgeBegin(c); e < dag.edgeEnd(c); ++e)
+            EXPECT_LT(index.position(c), index.position(dag.target(e)));
+    }
+
+    SearchContext context;
+    std::size_t nreachable = 0;
+    for (vertexid_t u = 0; u < nvertices; u += 7) {
+        std::vector<int> hops = BreadthFirstGraph::traverse(graph, u);
+        for (vertexid_t v = 0; v < nvertices; ++v) {
+            ASSERT_EQ(hops[v] >= 0, index.reaches(u, v, context)) << u << " -> " << v;
+            nreachable += hops[v] >= 0;
+        }
+    }
+    EXPECT_GT(nreachable, 0u);
+    EXPECT_TRUE(index.reaches(3, 3));
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -0,0 +1,48 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "SearchContext.h"
+
+#ifdef UNIT_TEST
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+#ifdef UNIT_TEST
+
+TEST(SearchContextTest, ResetByEpoch)
+{
+    SearchContext context{4};
+    context.reach(0, 0, SearchContext::kNoVertex);
+    context.reach(2, 5, 0);
+    context.reach(3, 7, 2);
+    context.settle(0);
+
+    EXPECT_TRUE(context.isReached(2));
+    EXPECT_TRUE(context.isSettled(0));
+    EXPECT_FALSE(context.isSettled(2));
+    EXPECT_EQ(SearchContext::kInfinity, context.distance(1));
+    EXPECT_EQ((std::vector<vertexid_t>{0, 2, 3}), context.path(3));
+    EXPECT_TRUE(context.path(1).empty());
+
+    std::uint32_t epoch = context.epoch();
+    context.reset(4);
+    EXPECT_EQ(epoch + 1, context.epoch());
+    for (vertexid_t v = 0; v < 4; ++v) {
+        EXPECT_FALSE(context.isReached(v));
+        EXPECT_FALSE(context.isSettled(v));
+        EXPECT_EQ(SearchContext::kInfinity, context.distance(v));
+    }
+
+    context.reach(1, 3, SearchContext::kNoVertex);
+    context.reset(8); // grows, the old marks must not come back
+    EXPECT_EQ(8u, context.nvertices());
+    EXPECT_EQ(std::vector<unsigned int>(8, SearchContext::kInfinity), context.distances());
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
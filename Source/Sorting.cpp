@@ -8,6 +8,11 @@
 #include "AlgoBase.h"
 
 #ifdef UNIT_TEST
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+
 #include "gtest/gtest.h"
 #endif
 
@@ -123,6 +128,33 @@ TEST(SortingTest, QuickSort)
     EXPECT_EQ(expected, a);
 }
 
+TEST(SortingTest, RadixSort)
+{
+    std::mt19937 random{22};
+    std::uniform_int_distribution<int> values{-1000000, 1000000};
+
+    // (value, original position), equal values must stay in order
+    std::vector<std::pair<int, std::size_t>> a;
+    for (std::size_t i = 0; i < 50000; ++i)
+        a.emplace_back(i % 7 == 0 ? 5 : values(random), i);
+    a.emplace_back(std::numeric_limits<int>::min(), a.size());
+    a.emplace_back(std::numeric_limits<int>::max(), a.size());
+
+    std::vector<std::pair<int, std::size_t>> expected{a};
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const std::pair<int, std::size_t>& lhs,
+                        const std::pair<int, std::size_t>& rhs) { return lhs.first < rhs.first; });
+
+    for (std::size_t nthreads : {1, 4}) {
+        ThreadPool pool{nthreads};
+        std::vector<std::pair<int, std::size_t>> actual{a};
+        psa::radixSort(actual, [](const std::pair<int, std::size_t>& p) {
+            return psa::radixKey(p.first);
+        }, pool);
+        EXPECT_EQ(expected, actual);
+    }
+}
+
 #endif // UNIT_TEST
 
 } // namespace psa
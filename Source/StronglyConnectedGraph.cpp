@@ -5,40 +5,39 @@
 
 #include "StronglyConnectedGraph.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "AlgoException.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
 
 #ifdef UNIT_TEST
 #include <fstream>
+#include <random>
 
-#include <fmt/format.h>
 #include <gtest/gtest.h>
+
+#include "BreadthFirstGraph.h"
+#include "SearchContext.h"
 #endif
 
 namespace psa {
 
-StronglyConnectedGraph::~StronglyConnectedGraph()
-{
-    for (auto redge : m_reverseEdges)
-        delete redge;
-
-    for (auto edge : m_edges)
-        delete edge;
-
-    for (auto vertex : m_vertices)
-        delete vertex;
-}
-
 edgeid_t StronglyConnectedGraph::addEdge(edgeid_t id, StronglyConnectedGraphVertex* u,
                                          StronglyConnectedGraphVertex* v, int /*value*/)
 {
-    auto e = new Edge<StronglyConnectedGraphVertex>{id, u, v};
+    auto e = this->createEdge(id, u, v);
     e->u()->addEdge(e);
     m_edges.push_back(e);
 
-    auto reverseEdge = new Edge<StronglyConnectedGraphVertex>{e->id(), e->v(), e->u()};
-    e->v()->addReverseEdge(reverseEdge);
-    m_reverseEdges.push_back(reverseEdge);
-
     ++id;
 
     return id;
@@ -46,80 +45,498 @@ edgeid_t StronglyConnectedGraph::addEdge(edgeid_t id, StronglyConnectedGraphVert
 
 namespace {
 
-unsigned int s_finishTime = 0;
-unsigned int nextFinishTime() { return s_finishTime++; }
+/**
+ * Pearce's variant of Tarjan: rindex[v] is the visit index of v while it is open, the lowest
+ * index it reaches once its edges are done and, after its component is complete, the component
+ * number counted down from n - 1. Open indexes stay below the numbers handed out, so an edge
+ * into a finished component never lowers anything. target(v, i) is the i-th out neighbor.
+ */
+template<typename Degree, typename Target>
+std::vector<unsigned int> pearceComponents(std::size_t nvertices, Degree degree, Target target)
+{
+    struct Frame
+    {
+        vertexid_t v;
+        std::size_t nextEdge;
+        bool isRoot;
+    };
+
+    std::vector<unsigned int> rindex(nvertices, 0);
+    std::vector<vertexid_t> visited; // open vertices whose component is not complete
+    std::vector<Frame> stack;
+
+    unsigned int index = 1;
+    unsigned int component = static_cast<unsigned int>(nvertices) - 1;
+
+    auto open = [&rindex, &stack, &index](vertexid_t v) {
+        rindex[v] = index++;
+        stack.push_back(Frame{v, 0, true});
+    };
+
+    for (vertexid_t s = 0; s < nvertices; ++s) {
+        if (rindex[s] != 0)
+            continue;
+
+        open(s);
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            vertexid_t v = frame.v;
+            if (frame.nextEdge < degree(v)) {
+                vertexid_t w = target(v, frame.nextEdge++);
+                if (rindex[w] == 0) {
+                    open(w);
+                } else if (rindex[w] < rindex[v]) {
+                    rindex[v] = rindex[w];
+                    frame.isRoot = false;
+                }
+                continue;
+            }
+
+            if (frame.isRoot) {
+                --index;
+                while (!visited.empty() && rindex[v] <= rindex[visited.back()]) {
+                    rindex[visited.back()] = component;
+                    visited.pop_back();
+                    --index;
+                }
+                rindex[v] = component--;
+            } else {
+                visited.push_back(v);
+            }
+
+            stack.pop_back();
+            if (!stack.empty() && rindex[v] < rindex[stack.back().v]) {
+                rindex[stack.back().v] = rindex[v];
+                stack.back().isRoot = false;
+            }
+        }
+    }
+
+    // n - 1 - number, so the first completed component gets 0
+    for (auto& id : rindex)
+        id = static_cast<unsigned int>(nvertices) - 1 - id;
+
+    return rindex;
+}
 
 } // anonymous
 
+std::vector<unsigned int> StronglyConnectedGraph::tarjan() const
+{
+    return pearceComponents(m_vertices.size(),
+                            [this](vertexid_t v) { return m_vertices[v]->edges().size(); },
+                            [this](vertexid_t v, std::size_t i) {
+                                return m_vertices[v]->edges()[i]->v()->id();
+                            });
+}
+
+std::vector<unsigned int> StronglyConnectedGraph::tarjan(const CsrGraph& graph)
+{
+    return pearceComponents(graph.nvertices(),
+                            [&graph](vertexid_t v) { return graph.degree(v); },
+                            [&graph](vertexid_t v, std::size_t i) {
+                                return graph.target(graph.edgeBegin(v) + i);
+                            });
+}
+
+namespace {
+
+const unsigned int kNoComponent = std::numeric_limits<unsigned int>::max();
+const vertexid_t kNoColor = std::numeric_limits<vertexid_t>::max();
+
+// no more remaining vertices than this are left to Tarjan
+const std::size_t kSerialVertices = 1 << 14;
+// a coloring round that does not settle in this many passes is left to Tarjan
+const std::size_t kColoringPasses = 64;
+
 /**
- * @brief StronglyConnectedGraph::kosaraju computes strongly connected components (SCC) for the
- * graph using Kosaraju's algorithm.
- * @return unordered_map that maps leader vertex id to size of SCC.
+ * Level synchronous search from source over the vertices with no component yet, marks them in
+ * reached. The next frontier is collected in a buffer per thread.
  */
-std::unordered_map<vertexid_t, unsigned int> StronglyConnectedGraph::kosaraju()
+void reachParallel(const CsrGraph& graph, vertexid_t source,
+                   const std::vector<unsigned int>& components, std::atomic<std::uint8_t>* reached,
+                   ThreadPool& pool)
 {
-    s_finishTime = 0; // make sure finishTime = 0 before starting
+    std::vector<vertexid_t> frontier{source};
+    std::vector<std::vector<vertexid_t>> buffers(pool.size());
+    reached[source].store(1, std::memory_order_relaxed);
+
+    while (!frontier.empty()) {
+        auto search = [&](std::size_t task, std::size_t first, std::size_t last) {
+            std::vector<vertexid_t>& buffer = buffers[task];
+            buffer.clear();
+            for (std::size_t i = first; i < last; ++i) {
+                vertexid_t u = frontier[i];
+                for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                    vertexid_t v = graph.target(e);
+                    if (components[v] == kNoComponent
+                            && reached[v].load(std::memory_order_relaxed) == 0
+                            && reached[v].exchange(1, std::memory_order_relaxed) == 0)
+                        buffer.push_back(v);
+                }
+            }
+        };
+        const std::size_t ntasks = pool.parallelForChunks(frontier.size(), search, 256);
+
+        frontier.clear();
+        for (std::size_t task = 0; task < ntasks; ++task)
+            frontier.insert(frontier.end(), buffers[task].begin(), buffers[task].end());
+    }
+}
 
-    this->dfsLoopReverse();
+} // anonymous
 
-    m_verticesByFinishTime.resize(m_vertices.size()); // resize, so we can index
+/**
+ * The phases only ever write the component of a vertex from the one task that owns it: trim
+ * and forward-backward write in passes over vertex chunks, coloring from the search of the root
+ * whose color the vertex has. Component ids come from a shared counter.
+ *
+ * Every coloring round is trimmed first. As in Multistep, what is left goes to Tarjan once it
+ * is small, once coloring needs too many passes (long paths) or once a round resolves little.
+ */
+std::vector<unsigned int> StronglyConnectedGraph::findComponents(const CsrGraph& graph,
+                                                                 ThreadPool& pool)
+{
+    const std::size_t nvertices = graph.nvertices();
+    CsrGraph reverse = graph.reverse();
+
+    std::vector<unsigned int> components(nvertices, kNoComponent);
+    std::atomic<unsigned int> nextComponent{0};
+
+    std::vector<vertexid_t> remaining(nvertices);
+    for (vertexid_t v = 0; v < nvertices; ++v)
+        remaining[v] = v;
+
+    // keeps the vertices with no component in remaining, in order
+    std::vector<std::vector<vertexid_t>> buffers(pool.size());
+    auto compact = [&]() {
+        for (auto& buffer : buffers)
+            buffer.clear();
+        pool.parallelForChunks(remaining.size(), [&](std::size_t task, std::size_t first,
+                                                     std::size_t last) {
+            std::vector<vertexid_t>& buffer = buffers[task];
+            for (std::size_t i = first; i < last; ++i) {
+                if (components[remaining[i]] == kNoComponent)
+                    buffer.push_back(remaining[i]);
+            }
+        });
+        remaining.clear();
+        for (auto& buffer : buffers)
+            remaining.insert(remaining.end(), buffer.begin(), buffer.end());
+    };
+
+    // trim: no edge in or no edge out among the remaining vertices means a component of one;
+    // a chain loses only its ends every round, so stop once a round trims little
+    std::vector<std::uint8_t> isTrivial(nvertices, 0);
+    auto hasEdge = [&components](const CsrGraph& g, vertexid_t v) {
+        for (edgeid_t e = g.edgeBegin(v); e < g.edgeEnd(v); ++e) {
+            if (components[g.target(e)] == kNoComponent)
+                return true;
+        }
+        return false;
+    };
+    auto trim = [&]() {
+        for (;;) {
+            std::atomic<std::size_t> ntrimmed{0};
+            pool.parallelForChunks(remaining.size(), [&](std::size_t, std::size_t first,
+                                                         std::size_t last) {
+                std::size_t count = 0;
+                for (std::size_t i = first; i < last; ++i) {
+                    vertexid_t v = remaining[i];
+                    isTrivial[v] = !hasEdge(graph, v) || !hasEdge(reverse, v);
+                    count += isTrivial[v];
+                }
+                ntrimmed += count;
+            });
+            if (ntrimmed == 0)
+                break;
+
+            pool.parallelForChunks(remaining.size(), [&](std::size_t, std::size_t first,
+                                                         std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    if (isTrivial[remaining[i]])
+                        components[remaining[i]] = nextComponent++;
+                }
+            });
+            const bool isLast = ntrimmed < remaining.size() / 64;
+            compact();
+            if (isLast)
+                break;
+        }
+    };
+
+    // Tarjan on the subgraph of the remaining vertices
+    auto finishSerially = [&]() {
+        std::vector<vertexid_t> local(nvertices, kNoColor);
+        for (vertexid_t i = 0; i < remaining.size(); ++i)
+            local[remaining[i]] = i;
+
+        std::vector<edgeid_t> offsets{0};
+        std::vector<vertexid_t> targets;
+        for (vertexid_t u : remaining) {
+            for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                if (local[graph.target(e)] != kNoColor)
+                    targets.push_back(local[graph.target(e)]);
+            }
+            offsets.push_back(targets.size());
+        }
+
+        std::vector<unsigned int> subComponents = pearceComponents(
+                remaining.size(),
+                [&offsets](vertexid_t v) { return offsets[v + 1] - offsets[v]; },
+                [&offsets, &targets](vertexid_t v, std::size_t i) {
+                    return targets[offsets[v] + i];
+                });
+
+        unsigned int ncomponents = 0;
+        for (vertexid_t i = 0; i < remaining.size(); ++i) {
+            components[remaining[i]] = nextComponent + subComponents[i];
+            ncomponents = std::max(ncomponents, subComponents[i] + 1);
+        }
+        nextComponent += ncomponents;
+        remaining.clear();
+    };
+
+    trim();
+
+    // forward-backward from the vertex of most edges in times out, likely in the giant one
+    if (!remaining.empty()) {
+        vertexid_t pivot = *std::max_element(remaining.begin(), remaining.end(),
+                [&graph, &reverse](vertexid_t a, vertexid_t b) {
+            return graph.degree(a) * reverse.degree(a) < graph.degree(b) * reverse.degree(b);
+        });
+
+        std::unique_ptr<std::atomic<std::uint8_t>[]> forward{
+                new std::atomic<std::uint8_t>[nvertices]};
+        std::unique_ptr<std::atomic<std::uint8_t>[]> backward{
+                new std::atomic<std::uint8_t>[nvertices]};
+        pool.parallelForChunks(nvertices, [&forward, &backward](std::size_t, std::size_t first,
+                                                                std::size_t last) {
+            for (std::size_t v = first; v < last; ++v) {
+                forward[v].store(0, std::memory_order_relaxed);
+                backward[v].store(0, std::memory_order_relaxed);
+            }
+        });
+        reachParallel(graph, pivot, components, forward.get(), pool);
+        reachParallel(reverse, pivot, components, backward.get(), pool);
+
+        const unsigned int giant = nextComponent++;
+        pool.parallelForChunks(remaining.size(), [&](std::size_t, std::size_t first,
+                                                     std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                vertexid_t v = remaining[i];
+                if (forward[v].load(std::memory_order_relaxed)
+                        && backward[v].load(std::memory_order_relaxed))
+                    components[v] = giant;
+            }
+        });
+        compact();
+    }
 
-    for (auto v : m_vertices) {
-        v->setExplored(false);
-        m_verticesByFinishTime[v->finishTime()] = v;
+    // coloring: every vertex ends up with the largest id of the remaining vertices reaching it
+    // a color is only read after checking it, a vertex with a component keeps its last color
+    std::unique_ptr<std::atomic<vertexid_t>[]> colors{new std::atomic<vertexid_t>[nvertices]};
+    pool.parallelForChunks(nvertices, [&colors](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t v = first; v < last; ++v)
+            colors[v].store(kNoColor, std::memory_order_relaxed);
+    });
+    std::vector<vertexid_t> roots;
+    while (!remaining.empty()) {
+        trim();
+        if (remaining.size() <= kSerialVertices) {
+            finishSerially();
+            break;
+        }
+        const std::size_t nremaining = remaining.size();
+
+        pool.parallelForChunks(remaining.size(), [&](std::size_t, std::size_t first,
+                                                     std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                colors[remaining[i]].store(remaining[i], std::memory_order_relaxed);
+        });
+
+        // a long path takes a pass per vertex on it, leave such a graph to Tarjan
+        std::size_t npasses = 0;
+        for (bool isChanged = true; isChanged && npasses <= kColoringPasses; ++npasses) {
+            std::atomic<bool> changed{false};
+            pool.parallelForChunks(remaining.size(), [&](std::size_t, std::size_t first,
+                                                         std::size_t last) {
+                bool isLocalChanged = false;
+                for (std::size_t i = first; i < last; ++i) {
+                    vertexid_t u = remaining[i];
+                    vertexid_t color = colors[u].load(std::memory_order_relaxed);
+                    for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                        vertexid_t v = graph.target(e);
+                        if (components[v] != kNoComponent)
+                            continue;
+                        vertexid_t old = colors[v].load(std::memory_order_relaxed);
+                        while (old < color && !colors[v].compare_exchange_weak(
+                                old, color, std::memory_order_relaxed)) {
+                        }
+                        isLocalChanged = isLocalChanged || old < color;
+                    }
+                }
+                if (isLocalChanged)
+                    changed = true;
+            });
+            isChanged = changed;
+        }
+        if (npasses > kColoringPasses) {
+            finishSerially();
+            break;
+        }
+
+        // a root kept its own color, its component is what reaches it backward in its color
+        roots.clear();
+        for (vertexid_t v : remaining) {
+            if (colors[v].load(std::memory_order_relaxed) == v)
+                roots.push_back(v);
+        }
+        pool.parallelFor(roots.size(), [&](std::size_t i) {
+            const vertexid_t root = roots[i];
+            const unsigned int component = nextComponent++;
+            std::vector<vertexid_t> stack{root};
+            components[root] = component;
+            while (!stack.empty()) {
+                vertexid_t v = stack.back();
+                stack.pop_back();
+                for (edgeid_t e = reverse.edgeBegin(v); e < reverse.edgeEnd(v); ++e) {
+                    vertexid_t u = reverse.target(e);
+                    if (colors[u].load(std::memory_order_relaxed) == root
+                            && components[u] == kNoComponent) {
+                        components[u] = component;
+                        stack.push_back(u);
+                    }
+                }
+            }
+        });
+        compact();
+
+        // as few resolved as trimming would, same as a chain
+        if (nremaining - remaining.size() < nremaining / 64)
+            finishSerially();
     }
 
-    this->dfsLoop();
+    return components;
+}
 
-    std::unordered_map<vertexid_t, unsigned int> leaderMap;
-    for (auto v : m_vertices)
-        ++leaderMap[v->leader()->id()];
+/**
+ * The component ids are the vertex ids of the condensation, the edges of every component are
+ * sorted and without duplicates.
+ */
+CsrGraph StronglyConnectedGraph::condense(const CsrGraph& graph,
+                                          const std::vector<unsigned int>& components)
+{
+    if (components.size() != graph.nvertices())
+        throw AlgoException{fmt::format(AlgoException::GraphIndexMismatch, "component",
+                                        components.size(), graph.nvertices())};
+
+    std::vector<CsrEdge> edges;
+    unsigned int ncomponents = 0;
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        ncomponents = std::max(ncomponents, components[u] + 1);
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            unsigned int cv = components[graph.target(e)];
+            if (components[u] != cv)
+                edges.push_back(CsrEdge{components[u], cv, 0});
+        }
+    }
 
-    return leaderMap;
+    auto key = [](const CsrEdge& e) { return std::make_pair(e.u, e.v); };
+    std::sort(edges.begin(), edges.end(),
+              [&key](const CsrEdge& a, const CsrEdge& b) { return key(a) < key(b); });
+    edges.erase(std::unique(edges.begin(), edges.end(),
+                            [&key](const CsrEdge& a, const CsrEdge& b) { return key(a) == key(b); }),
+                edges.end());
+
+    return CsrGraph{GraphType::Directed, ncomponents, edges};
 }
 
-void StronglyConnectedGraph::dfsLoopReverse()
+// Kahn's algorithm, a vertex goes out once all its incoming edges are gone
+std::vector<vertexid_t> StronglyConnectedGraph::topologicalOrder(const CsrGraph& dag)
 {
-    for (auto rit = m_vertices.rbegin(); rit != m_vertices.rend(); ++rit) {
-        if (!(*rit)->explored())
-            this->dfsReverse(*rit);
+    const std::size_t nvertices = dag.nvertices();
+    std::vector<unsigned int> nincoming(nvertices, 0);
+    for (edgeid_t e = 0; e < dag.nedges(); ++e)
+        ++nincoming[dag.target(e)];
+
+    std::vector<vertexid_t> order;
+    order.reserve(nvertices);
+    for (vertexid_t v = 0; v < nvertices; ++v) {
+        if (nincoming[v] == 0)
+            order.push_back(v);
+    }
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        vertexid_t u = order[head];
+        for (edgeid_t e = dag.edgeBegin(u); e < dag.edgeEnd(u); ++e) {
+            if (--nincoming[dag.target(e)] == 0)
+                order.push_back(dag.target(e));
+        }
     }
+
+    if (order.size() != nvertices) {
+        // a vertex left out may only be downstream of a cycle, but each one has a predecessor
+        // left out, so following those must come back around a cycle
+        std::vector<vertexid_t> predecessors(nvertices, kNoColor);
+        for (vertexid_t u = 0; u < nvertices; ++u) {
+            for (edgeid_t e = dag.edgeBegin(u); e < dag.edgeEnd(u) && nincoming[u] != 0; ++e) {
+                if (nincoming[dag.target(e)] != 0)
+                    predecessors[dag.target(e)] = u;
+            }
+        }
+
+        auto v = static_cast<vertexid_t>(std::find_if(nincoming.begin(), nincoming.end(),
+                                                      [](unsigned int n) { return n != 0; })
+                                         - nincoming.begin());
+        std::vector<bool> isSeen(nvertices, false);
+        for (; !isSeen[v]; v = predecessors[v])
+            isSeen[v] = true;
+        throw AlgoException{fmt::format(AlgoException::GraphNotAcyclic, v)};
+    }
+
+    return order;
 }
 
-void StronglyConnectedGraph::dfsReverse(StronglyConnectedGraphVertex* v)
+std::vector<unsigned int> StronglyConnectedGraph::componentSizes(
+        const std::vector<unsigned int>& components)
 {
-    v->setExplored(true);
-    for (auto e : v->reverseEdges()) {
-        if (!e->v()->explored())
-            this->dfsReverse(e->v());
+    std::vector<unsigned int> sizes;
+    for (unsigned int component : components) {
+        if (component >= sizes.size())
+            sizes.resize(component + 1, 0);
+        ++sizes[component];
     }
-    v->setFinishTime(nextFinishTime());
+    return sizes;
 }
 
-void StronglyConnectedGraph::dfsLoop()
+#ifdef UNIT_TEST
+
+namespace {
+
+// component sizes in decreasing order
+std::vector<unsigned int> sortedSizes(const std::vector<unsigned int>& components)
 {
-    StronglyConnectedGraphVertex* v;
-    for (auto rit = m_verticesByFinishTime.rbegin(); rit != m_verticesByFinishTime.rend(); ++rit) {
-        v = *rit;
-        if (!v->explored())
-            this->dfs(v, v);
-    }
+    std::vector<unsigned int> sizes = StronglyConnectedGraph::componentSizes(components);
+    std::sort(sizes.begin(), sizes.end(), std::greater<unsigned int>{});
+    return sizes;
 }
 
-void StronglyConnectedGraph::dfs(StronglyConnectedGraphVertex* v,
-                                 StronglyConnectedGraphVertex* leader)
+// every component named by its smallest vertex, to compare components numbered differently
+std::vector<vertexid_t> smallestVertices(const std::vector<unsigned int>& components)
 {
-    v->setExplored(true);
-    v->setLeader(leader);
-    for (auto e : v->edges()) {
-        if (!e->v()->explored())
-            this->dfs(e->v(), leader);
+    std::vector<vertexid_t> smallest(components.size(), 0);
+    std::vector<vertexid_t> first(components.size(), SearchContext::kNoVertex);
+    for (vertexid_t v = 0; v < components.size(); ++v) {
+        if (first[components[v]] == SearchContext::kNoVertex)
+            first[components[v]] = v;
+        smallest[v] = first[components[v]];
     }
+    return smallest;
 }
 
-#ifdef UNIT_TEST
+} // anonymous
 
-TEST(StronglyConnectedGraphTest, Kosaraju)
+TEST(StronglyConnectedGraphTest, Tarjan)
 {
     const std::string filename{"StronglyConnectedAdjList.txt"};
     std::ifstream stream{filename};
@@ -131,20 +548,193 @@ TEST(StronglyConnectedGraphTest, Kosaraju)
     EXPECT_EQ(StronglyConnectedGraph::Type::Directed, graph.type());
 
     std::vector<unsigned int> expected{4, 3, 3, 1};
+    EXPECT_EQ(expected, sortedSizes(graph.tarjan()));
+}
+
+TEST(StronglyConnectedGraphTest, CsrTarjan)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("StronglyConnectedAdjList.txt");
+
+    std::vector<unsigned int> expected{4, 3, 3, 1};
+    std::vector<unsigned int> components = StronglyConnectedGraph::tarjan(graph);
+    EXPECT_EQ(expected, sortedSizes(components));
+
+    // an edge between two components goes to one completed before
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e)
+            EXPECT_GE(components[u], components[graph.target(e)]);
+    }
+}
+
+TEST(StronglyConnectedGraphTest, RandomGraph)
+{
+    // u and v share a component exactly when each reaches the other
+    const std::size_t nvertices = 300;
+    CsrGraph graph = randomCsrGraph(GraphType::Directed, nvertices, nvertices + nvertices / 4, 18);
+
+    std::vector<unsigned int> components = StronglyConnectedGraph::tarjan(graph);
+    std::vector<std::vector<int>> hops;
+    for (vertexid_t v = 0; v < nvertices; ++v)
+        hops.push_back(BreadthFirstGraph::traverse(graph, v));
+
+    for (vertexid_t u = 0; u < nvertices; ++u) {
+        for (vertexid_t v = 0; v < nvertices; ++v) {
+            bool isStrong = hops[u][v] >= 0 && hops[v][u] >= 0;
+            EXPECT_EQ(isStrong, components[u] == components[v]) << u << ", " << v;
+        }
+    }
+}
+
+TEST(StronglyConnectedGraphTest, ParallelComponents)
+{
+    ThreadPool pool{4};
+
+    // sparse ones are mostly trimmed, denser ones have a giant component
+    for (unsigned int degree : {1, 2, 4}) {
+        const vertexid_t nvertices = 20000;
+        std::vector<CsrEdge> edges = randomCsrEdges(nvertices, degree * nvertices, 19 + degree);
+        // and some cycles of a few vertices hanging off it
+        for (vertexid_t v = 0; v + 3 < nvertices; v += 97) {
+            edges.push_back(CsrEdge{v, v + 1, 0});
+            edges.push_back(CsrEdge{v + 1, v + 2, 0});
+            edges.push_back(CsrEdge{v + 2, v, 0});
+        }
+        CsrGraph graph{GraphType::Directed, nvertices, edges};
+
+        std::vector<unsigned int> expected = StronglyConnectedGraph::tarjan(graph);
+        std::vector<unsigned int> actual = StronglyConnectedGraph::findComponents(graph, pool);
+        EXPECT_EQ(smallestVertices(expected), smallestVertices(actual)) << "degree " << degree;
+        EXPECT_EQ(sortedSizes(expected), sortedSizes(actual));
+
+        std::vector<unsigned int> sizes = StronglyConnectedGraph::componentSizes(actual);
+        EXPECT_EQ(sizes.end(), std::find(sizes.begin(), sizes.end(), 0u)) << "Ids must be dense!";
+    }
+
+    CsrGraph graph = CsrGraph::fromAdjList("StronglyConnectedAdjList.txt");
+    std::vector<unsigned int> expected{4, 3, 3, 1};
+    EXPECT_EQ(expected, sortedSizes(StronglyConnectedGraph::findComponents(graph, pool)));
+}
+
+TEST(StronglyConnectedGraphTest, ParallelColoring)
+{
+    // small strongly connected blocks, edges between them only go to later blocks, so nothing
+    // is trimmed and forward-backward takes just one block; coloring does the rest
+    std::mt19937 random{19};
+    const vertexid_t blockSize = 40;
+    const vertexid_t nblocks = 1000;
+    const vertexid_t nvertices = blockSize * nblocks;
+    std::uniform_int_distribution<vertexid_t> offsets{0, blockSize - 1};
+
+    std::vector<CsrEdge> edges;
+    for (vertexid_t block = 0; block < nblocks; ++block) {
+        const vertexid_t first = block * blockSize;
+        for (vertexid_t i = 0; i < blockSize; ++i) {
+            edges.push_back(CsrEdge{first + i, first + (i + 1) % blockSize, 0});
+            edges.push_back(CsrEdge{first + i, first + offsets(random), 0});
+            edges.push_back(CsrEdge{first + i, first + offsets(random), 0});
+            if (block + 1 < nblocks) {
+                std::uniform_int_distribution<vertexid_t> later{first + blockSize, nvertices - 1};
+                edges.push_back(CsrEdge{first + i, later(random), 0});
+            }
+        }
+    }
+    CsrGraph graph{GraphType::Directed, nvertices, edges};
+
+    ThreadPool pool{4};
+    std::vector<unsigned int> expected = StronglyConnectedGraph::tarjan(graph);
+    std::vector<unsigned int> actual = StronglyConnectedGraph::findComponents(graph, pool);
+    EXPECT_EQ(smallestVertices(expected), smallestVertices(actual));
+    EXPECT_EQ(nblocks, StronglyConnectedGraph::componentSizes(actual).size());
+}
+
+TEST(StronglyConnectedGraphTest, ParallelLongChains)
+{
+    // edges against the vertex order: trimming takes only the ends and coloring a pass per hop
+    const vertexid_t nvertices = 200000;
+    std::vector<CsrEdge> edges;
+    for (vertexid_t v = 0; v + 1 < nvertices; ++v)
+        edges.push_back(CsrEdge{v + 1, v, 0});
+    // and a second chain of 2-cycles, nothing there to trim at all
+    std::vector<CsrEdge> cycles;
+    for (vertexid_t v = 0; v + 1 < nvertices; ++v) {
+        cycles.push_back(CsrEdge{v + 1, v, 0});
+        if (v % 2 == 0)
+            cycles.push_back(CsrEdge{v, v + 1, 0});
+    }
 
-    std::unordered_map<vertexid_t, unsigned int> leaderMap = graph.kosaraju();
+    ThreadPool pool{4};
+    for (auto* chainEdges : {&edges, &cycles}) {
+        CsrGraph graph{GraphType::Directed, nvertices, *chainEdges};
+        std::vector<unsigned int> expected = StronglyConnectedGraph::tarjan(graph);
+        std::vector<unsigned int> actual = StronglyConnectedGraph::findComponents(graph, pool);
+        EXPECT_EQ(smallestVertices(expected), smallestVertices(actual));
+    }
+}
 
-    std::vector<unsigned int> scc;
-    for (auto leader : leaderMap)
-        scc.push_back(leader.second);
+TEST(StronglyConnectedGraphTest, Condensation)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("StronglyConnectedAdjList.txt");
+    std::vector<unsigned int> components = StronglyConnectedGraph::tarjan(graph);
+    CsrGraph dag = StronglyConnectedGraph::condense(graph, components);
+    ASSERT_EQ(4u, dag.nvertices());
+
+    std::vector<vertexid_t> order = StronglyConnectedGraph::topologicalOrder(dag);
+    ASSERT_EQ(dag.nvertices(), order.size());
+    std::vector<vertexid_t> positions(order.size());
+    for (vertexid_t i = 0; i < order.size(); ++i)
+        positions[order[i]] = i;
+
+    // every graph edge is either inside a component or a dag edge going forward
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+            unsigned int cu = components[u];
+            unsigned int cv = components[graph.target(e)];
+            if (cu == cv)
+                continue;
+            EXPECT_LT(positions[cu], positions[cv]);
+            EXPECT_TRUE(std::binary_search(dag.targets() + dag.edgeBegin(cu),
+                                           dag.targets() + dag.edgeEnd(cu), cv));
+        }
+    }
 
-    std::sort(scc.begin(), scc.end(), std::greater<unsigned int>{});
+    bool passed = false;
+    try {
+        StronglyConnectedGraph::topologicalOrder(graph);
+    } catch (const AlgoException& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "A graph with a cycle has no topological order!";
+
+    // 0 is only downstream of the cycle 2 -> 3 -> 2, the one named is on it
+    CsrGraph downstream{GraphType::Directed, 4, {{1, 2, 0}, {2, 3, 0}, {3, 2, 0}, {3, 0, 0}}};
+    try {
+        StronglyConnectedGraph::topologicalOrder(downstream);
+        ADD_FAILURE() << "A graph with a cycle has no topological order!";
+    } catch (const AlgoException& e) {
+        const std::string message{e.what()};
+        EXPECT_TRUE(message == fmt::format(AlgoException::GraphNotAcyclic, 2)
+                    || message == fmt::format(AlgoException::GraphNotAcyclic, 3)) << message;
+    }
+}
 
-    EXPECT_EQ(expected, scc);
+TEST(StronglyConnectedGraphTest, DeepGraph)
+{
+    // one long cycle plus a long tail into it, far deeper than the call stack could go
+    const vertexid_t length = 1000000;
+    std::vector<CsrEdge> edges;
+    for (vertexid_t v = 0; v < length; ++v)
+        edges.push_back(CsrEdge{v, (v + 1) % length, 0});
+    for (vertexid_t v = length; v < 2 * length; ++v)
+        edges.push_back(CsrEdge{v, v + 1 < 2 * length ? v + 1 : 0, 0});
+    CsrGraph graph{GraphType::Directed, 2 * length, edges};
+
+    std::vector<unsigned int> sizes = sortedSizes(StronglyConnectedGraph::tarjan(graph));
+    ASSERT_EQ(length + 1, sizes.size());
+    EXPECT_EQ(length, sizes.front());
+    EXPECT_EQ(1u, sizes.back());
 }
 
-#ifdef NDEBUG // release mode only as it takes long time!
-TEST(StronglyConnectedGraphTest, AlgoClassKosaraju)
+TEST(StronglyConnectedGraphTest, AlgoClassTarjan)
 {
     const std::string filename{"AlgoClassStronglyConnectedAdjList.txt"};
     std::ifstream stream{filename};
@@ -157,20 +747,13 @@ TEST(StronglyConnectedGraphTest, AlgoClassKosaraju)
 
     std::vector<unsigned int> expected{434821, 968, 459, 313, 211};
 
-    std::unordered_map<vertexid_t, unsigned int> leaderMap = graph.kosaraju();
-    EXPECT_GE(leaderMap.size(), expected.size());
-
-    std::vector<unsigned int> scc;
-    for (auto leader : leaderMap)
-        scc.push_back(leader.second);
-
-    std::sort(scc.begin(), scc.end(), std::greater<unsigned int>{});
+    std::vector<unsigned int> scc = sortedSizes(graph.tarjan());
+    ASSERT_GE(scc.size(), expected.size());
 
     std::vector<unsigned int> scc2{scc.begin(), scc.begin() + expected.size()};
 
     EXPECT_EQ(expected, scc2);
 }
-#endif
 
 #endif // UNIT_TEST
 
@@ -0,0 +1,225 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#ifdef UNIT_TEST
+#include <numeric>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#endif
+
+namespace psa {
+
+namespace {
+
+// the pool whose tasks this thread is running, a parallelFor on it from a task runs inline
+thread_local const ThreadPool* tRunningPool = nullptr;
+
+} // anonymous
+
+const std::size_t ThreadPool::kChunkGrain;
+
+ThreadPool::ThreadPool(std::size_t nthreads)
+{
+    if (nthreads == 0)
+        nthreads = 1;
+
+    m_workers.reserve(nthreads - 1);
+    for (std::size_t i = 1; i < nthreads; ++i)
+        m_workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+std::size_t ThreadPool::defaultThreadCount()
+{
+    std::size_t n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+void ThreadPool::parallelFor(std::size_t n, const std::function<void(std::size_t)>& func)
+{
+    if (m_workers.empty() || n <= 1 || tRunningPool == this) {
+        for (std::size_t i = 0; i < n; ++i)
+            func(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock{m_runMutex};
+
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_func = &func;
+        m_ntasks = n;
+        m_nextTask = 0;
+        m_exception = nullptr;
+        m_nbusy = m_workers.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    this->runTasks();
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_done.wait(lock, [this] { return m_nbusy == 0; });
+        m_func = nullptr;
+        exception = m_exception;
+        m_exception = nullptr;
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void ThreadPool::work()
+{
+    std::size_t generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_start.wait(lock, [this, generation] {
+                return m_stop || m_generation != generation;
+            });
+            if (m_stop)
+                return;
+            generation = m_generation;
+        }
+
+        this->runTasks();
+
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (--m_nbusy == 0)
+                m_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runTasks()
+{
+    const ThreadPool* runningPool = tRunningPool;
+    tRunningPool = this;
+
+    for (;;) {
+        std::size_t i = m_nextTask.fetch_add(1);
+        if (i >= m_ntasks)
+            break;
+
+        try {
+            (*m_func)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (!m_exception)
+                m_exception = std::current_exception();
+            m_nextTask = m_ntasks; // don't hand out any more tasks
+        }
+    }
+
+    tRunningPool = runningPool;
+}
+
+std::size_t ThreadPool::parallelForChunks(
+        std::size_t n,
+        const std::function<void(std::size_t, std::size_t, std::size_t)>& func,
+        std::size_t grain)
+{
+    const std::size_t nchunks = std::min(this->size(),
+                                         std::max<std::size_t>(n / std::max<std::size_t>(grain, 1),
+                                                               1));
+    this->parallelFor(nchunks, [n, nchunks, &func](std::size_t chunk) {
+        func(chunk, n * chunk / nchunks, n * (chunk + 1) / nchunks);
+    });
+    return nchunks;
+}
+
+#ifdef UNIT_TEST
+
+TEST(ThreadPoolTest, ParallelFor)
+{
+    ThreadPool pool{4};
+    EXPECT_EQ(4u, pool.size());
+
+    for (int round = 0; round < 10; ++round) {
+        std::vector<std::size_t> values(1000, 0);
+        pool.parallelFor(values.size(), [&values](std::size_t i) { values[i] = i; });
+
+        std::vector<std::size_t> expected(values.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        EXPECT_EQ(expected, values);
+    }
+
+    bool passed = false;
+    try {
+        pool.parallelFor(100, [](std::size_t i) {
+            if (i == 42)
+                throw std::runtime_error{"task failed"};
+        });
+    } catch (const std::runtime_error& /*e*/) {
+        passed = true;
+    }
+    EXPECT_TRUE(passed) << "Exception thrown by a task should reach the caller!";
+}
+
+TEST(ThreadPoolTest, NestedParallelFor)
+{
+    ThreadPool pool{4};
+    std::vector<std::size_t> values(64 * 64, 0);
+    pool.parallelFor(64, [&pool, &values](std::size_t i) {
+        pool.parallelFor(64, [&values, i](std::size_t j) { values[64 * i + j] = 64 * i + j; });
+    });
+
+    std::vector<std::size_t> expected(values.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(expected, values);
+
+    // a nested loop on another pool still runs in parallel
+    ThreadPool inner{2};
+    std::atomic<std::size_t> sum{0};
+    pool.parallelFor(8, [&inner, &sum](std::size_t) {
+        inner.parallelFor(100, [&sum](std::size_t j) { sum += j; });
+    });
+    EXPECT_EQ(8u * 4950u, sum.load());
+}
+
+TEST(ThreadPoolTest, ParallelForChunks)
+{
+    ThreadPool pool{4};
+    for (std::size_t n : {0, 10, 1500, 3000, 5000, 100000}) {
+        std::vector<std::size_t> values(n, 0);
+        std::vector<std::size_t> sizes(pool.size(), 0);
+        std::size_t nchunks = pool.parallelForChunks(n, [&](std::size_t chunk, std::size_t first,
+                                                            std::size_t last) {
+            sizes[chunk] = last - first;
+            for (std::size_t i = first; i < last; ++i)
+                values[i] = i + 1;
+        });
+
+        EXPECT_LE(nchunks, pool.size());
+        EXPECT_EQ(n < 2 * ThreadPool::kChunkGrain ? 1u : std::min(pool.size(), n / 1024), nchunks);
+        EXPECT_EQ(n, std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}));
+        for (std::size_t i = 0; i < n; ++i)
+            ASSERT_EQ(i + 1, values[i]);
+    }
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa
@@ -0,0 +1,213 @@
+/**
+ * Copyright 2016, Saravanan Poosanthiram
+ * All rights reserved.
+ */
+
+#include "UnionFind.h"
+
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "CsrGraph.h"
+
+#ifdef UNIT_TEST
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "ThreadPool.h"
+#endif
+
+namespace psa {
+
+UnionFind UnionFind::connect(const CsrGraph& graph)
+{
+    UnionFind sets{graph.nvertices()};
+    for (vertexid_t u = 0; u < graph.nvertices(); ++u) {
+        for (edgeid_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e)
+            sets.unite(u, graph.target(e));
+    }
+    return sets;
+}
+
+void UnionFind::reset(std::size_t nelements)
+{
+    m_parent.resize(nelements);
+    std::iota(m_parent.begin(), m_parent.end(), 0);
+    m_size.assign(nelements, 1);
+    m_nsets = nelements;
+}
+
+bool UnionFind::unite(vertexid_t u, vertexid_t v)
+{
+    u = this->find(u);
+    v = this->find(v);
+    if (u == v)
+        return false;
+
+    if (m_size[u] < m_size[v])
+        std::swap(u, v);
+    m_parent[v] = u;
+    m_size[u] += m_size[v];
+    --m_nsets;
+
+    return true;
+}
+
+std::vector<unsigned int> UnionFind::labels()
+{
+    const unsigned int kNoLabel = std::numeric_limits<unsigned int>::max();
+
+    std::vector<unsigned int> rootLabels(m_parent.size(), kNoLabel);
+    std::vector<unsigned int> labels(m_parent.size());
+    unsigned int nlabels = 0;
+    for (vertexid_t v = 0; v < m_parent.size(); ++v) {
+        vertexid_t root = this->find(v);
+        if (rootLabels[root] == kNoLabel)
+            rootLabels[root] = nlabels++;
+        labels[v] = rootLabels[root];
+    }
+    return labels;
+}
+
+ConcurrentUnionFind::ConcurrentUnionFind(std::size_t nelements)
+    : m_nelements{nelements}
+    , m_parent{new std::atomic<std::uint32_t>[nelements]}
+{
+    for (std::size_t v = 0; v < nelements; ++v)
+        m_parent[v].store(static_cast<std::uint32_t>(v), std::memory_order_relaxed);
+}
+
+bool ConcurrentUnionFind::unite(vertexid_t u, vertexid_t v)
+{
+    for (;;) {
+        u = this->find(u);
+        v = this->find(v);
+        if (u == v)
+            return false;
+
+        if (u < v)
+            std::swap(u, v);
+        std::uint32_t root = u;
+        if (m_parent[u].compare_exchange_strong(root, v, std::memory_order_acq_rel))
+            return true;
+    }
+}
+
+bool ConcurrentUnionFind::isSame(vertexid_t u, vertexid_t v)
+{
+    // u is still a root after v was found, so the two were apart at that point
+    for (;;) {
+        u = this->find(u);
+        v = this->find(v);
+        if (u == v)
+            return true;
+        if (m_parent[u].load(std::memory_order_acquire) == u)
+            return false;
+    }
+}
+
+#ifdef UNIT_TEST
+
+TEST(UnionFindTest, UniteFind)
+{
+    UnionFind sets{10};
+    EXPECT_EQ(10u, sets.nsets());
+
+    EXPECT_TRUE(sets.unite(1, 2));
+    EXPECT_TRUE(sets.unite(3, 4));
+    EXPECT_TRUE(sets.unite(2, 4));
+    EXPECT_FALSE(sets.unite(1, 3));
+    EXPECT_TRUE(sets.unite(8, 9));
+
+    EXPECT_EQ(6u, sets.nsets());
+    EXPECT_TRUE(sets.isSame(1, 4));
+    EXPECT_FALSE(sets.isSame(0, 1));
+    EXPECT_EQ(4u, sets.size(3));
+    EXPECT_EQ(1u, sets.size(5));
+
+    std::vector<unsigned int> expected{0, 1, 1, 1, 1, 2, 3, 4, 5, 5};
+    EXPECT_EQ(expected, sets.labels());
+
+    sets.reset(3);
+    EXPECT_EQ(3u, sets.nsets());
+    EXPECT_FALSE(sets.isSame(1, 2));
+}
+
+TEST(UnionFindTest, Random)
+{
+    // against a plain label array relabeled on every union
+    std::mt19937 random{21};
+    const std::size_t nelements = 500;
+    std::uniform_int_distribution<vertexid_t> elements{0, nelements - 1};
+
+    UnionFind sets{nelements};
+    std::vector<vertexid_t> naive(nelements);
+    std::iota(naive.begin(), naive.end(), 0);
+
+    for (int i = 0; i < 400; ++i) {
+        vertexid_t u = elements(random);
+        vertexid_t v = elements(random);
+        EXPECT_EQ(naive[u] != naive[v], sets.unite(u, v));
+
+        vertexid_t from = naive[v];
+        for (auto& label : naive) {
+            if (label == from)
+                label = naive[u];
+        }
+
+        vertexid_t a = elements(random);
+        vertexid_t b = elements(random);
+        EXPECT_EQ(naive[a] == naive[b], sets.isSame(a, b));
+    }
+}
+
+TEST(UnionFindTest, ConnectedComponents)
+{
+    CsrGraph graph = CsrGraph::fromAdjList("KargerMinCutAdjList.txt");
+    UnionFind sets = UnionFind::connect(graph);
+    EXPECT_EQ(1u, sets.nsets());
+    EXPECT_EQ(graph.nvertices(), sets.size(0));
+
+    std::vector<CsrEdge> edges{{0, 1, 0}, {2, 3, 0}, {3, 4, 0}};
+    CsrGraph forest{GraphType::Undirected, 6, edges};
+    std::vector<unsigned int> expected{0, 0, 1, 1, 1, 2};
+    EXPECT_EQ(expected, UnionFind::connect(forest).labels());
+}
+
+TEST(UnionFindTest, ConcurrentUnite)
+{
+    std::mt19937 random{23};
+    const std::size_t nelements = 100000;
+    std::uniform_int_distribution<vertexid_t> elements{0, nelements - 1};
+
+    std::vector<std::pair<vertexid_t, vertexid_t>> pairs(nelements);
+    for (auto& pair : pairs)
+        pair = {elements(random), elements(random)};
+
+    UnionFind expected{nelements};
+    for (auto& pair : pairs)
+        expected.unite(pair.first, pair.second);
+
+    ThreadPool pool{4};
+    ConcurrentUnionFind sets{nelements};
+    std::atomic<std::size_t> nunited{0};
+    pool.parallelFor(pairs.size(), [&](std::size_t i) {
+        if (sets.unite(pairs[i].first, pairs[i].second))
+            nunited.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    EXPECT_EQ(nelements - expected.nsets(), nunited.load());
+    for (std::size_t i = 0; i < 1000; ++i) {
+        vertexid_t a = elements(random);
+        vertexid_t b = i % 2 ? elements(random) : pairs[a].second;
+        EXPECT_EQ(expected.isSame(a, b), sets.isSame(a, b));
+    }
+    for (vertexid_t v = 0; v < nelements; ++v)
+        EXPECT_EQ(sets.find(expected.find(v)), sets.find(v));
+}
+
+#endif // UNIT_TEST
+
+} // namespace psa